@@ -28,6 +28,7 @@ extern "C"
 
 /* Includes ------------------------------------------------------------------*/
 #include "driver/gpio.h"
+#include "st7735_panel.h"
 // #include "spi.h"
 /* Includes ------------------------------------------------------------------*/
 #define LCD_NUMBER 0x00
@@ -40,6 +41,16 @@ extern "C"
 #define LCD_CS_PIN GPIO_NUM_15    // D8
 #define LCD_BLK_PIN GPIO_NUM_4    // D2
 
+/* Second panel on the same HSPI bus, used when LCD_INSTANCES_NBR is 2: SCL, SDA,
+   RESET and BLK are shared, CS is its own. D/C is only sampled while CS is low,
+   so it may be shared as well */
+#ifndef LCD1_CS_PIN
+#define LCD1_CS_PIN GPIO_NUM_2 // D4
+#endif
+#ifndef LCD1_DC_PIN
+#define LCD1_DC_PIN LCD_DC_PIN
+#endif
+
 #define GPIO_PIN_SET 1
 #define GPIO_PIN_RESET 0
 
@@ -70,6 +81,7 @@ extern "C"
 #define LCD_PIXEL_FORMAT_L8 0x00000005U       /*!< L8 LTDC pixel format       */
 #define LCD_PIXEL_FORMAT_AL44 0x00000006U     /*!< AL44 LTDC pixel format     */
 #define LCD_PIXEL_FORMAT_AL88 0x00000007U     /*!< AL88 LTDC pixel format     */
+#define LCD_PIXEL_FORMAT_RGB444 0x00000008U   /*!< RGB444 12 bpp on the bus   */
 /**
  * @}
  */
@@ -172,18 +184,40 @@ extern "C"
     int32_t (*DrawString)(void *, uint32_t, uint32_t, uint8_t *, uint8_t, uint32_t, uint32_t);
     int32_t (*GetXSize)(void *, uint32_t *);
     int32_t (*GetYSize)(void *, uint32_t *);
+    int32_t (*DrawBitmapAsync)(void *, uint32_t, uint32_t, uint32_t, uint32_t, uint8_t *);
+    int32_t (*FillRGBRectStride)(void *, uint32_t, uint32_t, uint8_t *, uint32_t, uint32_t, uint32_t);
+    int32_t (*DrawRect)(void *, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
+    int32_t (*SetScrollArea)(void *, uint32_t, uint32_t);
+    int32_t (*SetScrollOffset)(void *, uint32_t);
+    int32_t (*SetColorCoding)(void *, uint32_t);
+    int32_t (*SetPowerMode)(void *, uint32_t, uint32_t, uint32_t);
+    int32_t (*SetFrameRate)(void *, uint32_t);
+    int32_t (*GetFrameRate)(void *, uint32_t *);
+    int32_t (*Sleep)(void *);
+    int32_t (*Resume)(void *, uint32_t, uint32_t);
+    int32_t (*FillRGBRectStrideAsync)(void *, uint32_t, uint32_t, uint8_t *, uint32_t, uint32_t, uint32_t);
   } LCD_Drv_t;
 
 /** @defgroup ADAFRUIT_802_LCD_Exported_Constants LCD Exported Constants
  * @{
  */
-#define LCD_INSTANCES_NBR 1U
+#ifndef LCD_INSTANCES_NBR
+#define LCD_INSTANCES_NBR 1U /* Panels on the HSPI bus, 1 or 2 */
+#endif
+
+#define LCD_PANEL_WIDTH ST7735_PANEL_WIDTH   /* Panel width in portrait, from its profile  */
+#define LCD_PANEL_HEIGHT ST7735_PANEL_HEIGHT /* Panel height in portrait, from its profile */
+#define LCD_PANEL_NAME ((ST7735_PANEL_CONTROLLER == ST7735_CONTROLLER_ST7789) ? "st7789" : "st7735")
 
 #define LCD_ORIENTATION_PORTRAIT 0x00U         /* Portrait orientation choice of LCD screen               */
 #define LCD_ORIENTATION_PORTRAIT_ROT180 0x01U  /* Portrait rotated 180° orientation choice of LCD screen  */
 #define LCD_ORIENTATION_LANDSCAPE 0x02U        /* Landscape orientation choice of LCD screen              */
 #define LCD_ORIENTATION_LANDSCAPE_ROT180 0x03U /* Landscape rotated 180° orientation choice of LCD screen */
 
+#define LCD_POWER_MODE_NORMAL 0x00U  /* Whole display, full colors                         */
+#define LCD_POWER_MODE_IDLE 0x01U    /* Whole display, 8 colors                            */
+#define LCD_POWER_MODE_PARTIAL 0x02U /* Lines outside the partial area dark, portrait only */
+
   /**
    * @}
    */
@@ -197,8 +231,25 @@ extern "C"
     uint32_t YSize;
     uint32_t PixelFormat;
     uint32_t IsMspCallbacksValid;
+    /* Hardware scroll: lines ScrollTop .. ScrollTop + ScrollHeight - 1, 0: off */
+    uint32_t ScrollTop;
+    uint32_t ScrollHeight;
+    uint32_t ScrollOffset;
+    /* Display mode, LCD_POWER_MODE_NORMAL .. LCD_POWER_MODE_PARTIAL */
+    uint32_t PowerMode;
+    /* Set by LCD_Resume(): the panel still shows what it did before LCD_Sleep() */
+    uint32_t Resumed;
   } LCD_Ctx_t;
 
+  typedef struct
+  {
+    uint32_t Transactions;       /* SPI transactions of the panel, commands and data */
+    uint32_t Windows;            /* Address windows set by the driver */
+    uint32_t WindowTransactions; /* SPI transactions spent on address windows */
+    uint32_t GlyphHits;          /* Characters drawn from the glyph cache, all instances */
+    uint32_t GlyphMisses;        /* Characters expanded from the font tables, all instances */
+  } LCD_Stats_t;
+
   /** @addtogroup ADAFRUIT_802_LCD_Exported_Variables
    * @{
    */
@@ -212,6 +263,8 @@ extern "C"
    * @{
    */
   int32_t LCD_Init(uint32_t Instance, uint32_t Orientation);
+  int32_t LCD_Sleep(uint32_t Instance);
+  int32_t LCD_Resume(uint32_t Instance);
   // int32_t LCD_DeInit(uint32_t Instance);
 
   /* LCD generic APIs: Display control */
@@ -221,19 +274,45 @@ extern "C"
   int32_t LCD_GetBrightness(uint32_t Instance, uint32_t *Brightness);
   int32_t LCD_GetXSize(uint32_t Instance, uint32_t *XSize);
   int32_t LCD_GetYSize(uint32_t Instance, uint32_t *YSize);
+  int32_t LCD_GetStats(uint32_t Instance, LCD_Stats_t *Stats);
+  int32_t LCD_SetPowerMode(uint32_t Instance, uint32_t Mode, uint32_t Start, uint32_t End);
+  int32_t LCD_GetPowerMode(uint32_t Instance, uint32_t *Mode);
+  int32_t LCD_SetFrameRate(uint32_t Instance, uint32_t Rate);
+  int32_t LCD_GetFrameRate(uint32_t Instance, uint32_t *Rate);
 
   /* LCD generic APIs: Draw operations. This list of APIs is required for
      lcd gfx utilities */
   int32_t LCD_GetPixelFormat(uint32_t Instance, uint32_t *PixelFormat);
+  int32_t LCD_SetPixelFormat(uint32_t Instance, uint32_t PixelFormat);
+  int32_t LCD_SetDither(uint32_t Instance, uint32_t Enable);
+  int32_t LCD_SetLut(uint32_t Instance, const uint16_t *pLut);
+  int32_t LCD_GetLut(uint32_t Instance, const uint16_t **ppLut);
+  void LCD_MakeLutRGB332(uint16_t *pLut);
   int32_t LCD_DrawBitmap(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t width, uint32_t height, uint8_t *pBmp);
+  int32_t LCD_DrawBitmapAsync(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t width, uint32_t height, uint8_t *pBmp);
   int32_t LCD_FillRGBRect(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint8_t *pData, uint32_t Width, uint32_t Height);
+  int32_t LCD_FillRGBRectStride(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint8_t *pData, uint32_t Width, uint32_t Height, uint32_t Stride);
+  int32_t LCD_FillRGBRectStrideAsync(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint8_t *pData, uint32_t Width, uint32_t Height, uint32_t Stride);
   int32_t LCD_DrawHLine(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Length, uint32_t Color);
   int32_t LCD_DrawVLine(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Length, uint32_t Color);
   int32_t LCD_FillRect(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Width, uint32_t Height, uint32_t Color);
+  int32_t LCD_DrawRect(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Width, uint32_t Height, uint32_t Color);
   int32_t LCD_ReadPixel(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t *Color);
   int32_t LCD_WritePixel(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Color);
   int32_t LCD_DrawChar(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint8_t num, uint8_t size, uint32_t fColor, uint32_t bColor, uint8_t mode);
   int32_t LCD_DrawString(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint8_t *string, uint8_t size, uint32_t fColor, uint32_t bColor);
+
+  /* LCD hardware scrolling, portrait only: the content of the scroll area moves
+     up without being redrawn, only the exposed lines need drawing */
+  int32_t LCD_ScrollSetArea(uint32_t Instance, uint32_t Top, uint32_t Bottom);
+  int32_t LCD_ScrollSetOffset(uint32_t Instance, uint32_t Offset);
+  int32_t LCD_ScrollLines(uint32_t Instance, uint32_t Lines, uint32_t Color);
+  int32_t LCD_ScrollGetLine(uint32_t Instance, uint32_t Line, uint32_t *Ypos);
+
+  /* LCD asynchronous transfer: LCD_SignalTransferDone() is called from the SPI
+     interrupt once the last pixel of LCD_DrawBitmapAsync() is in the FIFO */
+  void LCD_SignalTransferDone(uint32_t Instance);
+  void LCD_IO_SpiEventCallback(int event, void *arg);
   /**
    * @}
    */
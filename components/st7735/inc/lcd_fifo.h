@@ -0,0 +1,78 @@
+/**
+ ******************************************************************************
+ * @file    lcd_fifo.h
+ * @brief   This file contains the packing of a byte stream into HSPI FIFO
+ *          words, shared by lcd.c and the host test in tools/.
+ ******************************************************************************
+ * @attention
+ *
+ * The HSPI FIFO is SPI1.data_buf[], LCD_FIFO_SIZE bytes as 32-bit words. With
+ * BYTE_TX_ORDER = 0 (see espx_spi_init) the least significant byte of a word
+ * is shifted out first, so byte n of a transaction is bits 8 x (n % 4) of word
+ * n / 4. Nothing here touches the hardware.
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _LCD_FIFO_H
+#define _LCD_FIFO_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/** @defgroup LCD_FIFO_Exported_Constants LCD FIFO Exported Constants
+ * @{
+ */
+#define LCD_FIFO_SIZE 64U /* HSPI data_buf[]: 16 x 32-bit words */
+  /**
+   * @}
+   */
+
+  /** @defgroup LCD_FIFO_Exported_Functions LCD FIFO Exported Functions
+   * @{
+   */
+  /**
+   * @brief  Pack the next FIFO load of a byte stream into words.
+   * @note   A tail shorter than 4 bytes only uses the low bytes of the last
+   *         word, the others are 0.
+   * @param  pWords at least LCD_FIFO_SIZE / 4 words
+   * @param  pData  bytes to send, any alignment
+   * @param  Length bytes left to send
+   * @retval Bytes packed, up to LCD_FIFO_SIZE, in (bytes + 3) / 4 words
+   */
+  static inline __attribute__((always_inline)) uint32_t LCD_FIFO_Pack(uint32_t *pWords, const uint8_t *pData,
+                                                                       uint32_t Length)
+  {
+    uint32_t chunk = (Length > LCD_FIFO_SIZE) ? LCD_FIFO_SIZE : Length;
+    uint32_t i, word;
+
+    for (i = 0; i + 4U <= chunk; i += 4U)
+    {
+      *pWords++ = (uint32_t)pData[i] | ((uint32_t)pData[i + 1U] << 8) | ((uint32_t)pData[i + 2U] << 16) |
+                  ((uint32_t)pData[i + 3U] << 24);
+    }
+    if (i < chunk)
+    {
+      for (word = 0; i < chunk; i++)
+      {
+        word |= (uint32_t)pData[i] << (8U * (i & 3U));
+      }
+      *pWords = word;
+    }
+
+    return chunk;
+  }
+  /**
+   * @}
+   */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _LCD_FIFO_H */
@@ -0,0 +1,81 @@
+/**
+ ******************************************************************************
+ * @file    lcd_font.h
+ * @brief   This file contains the defines and functions prototypes for the
+ *          double-byte (GBK) font read from the file system.
+ ******************************************************************************
+ * @attention
+ *
+ * Font file layout, all numbers little-endian:
+ *   0  char     Magic[4]    "GFNT"
+ *   4  uint8_t  Width       glyph width in pixels
+ *   5  uint8_t  Height      glyph height in pixels, the font size
+ *   6  uint16_t Runs        number of index runs
+ *   8  Runs x { uint16_t First; uint16_t Count; uint16_t Glyph; }
+ *      consecutive GBK codes First .. First + Count - 1 are glyphs
+ *      Glyph .. Glyph + Count - 1, sorted by First
+ *   .. glyphs, ceil(Width / 8) * Height bytes each, row-major, MSB on the left
+ *
+ * The index is kept in RAM, glyphs are read through a small page cache.
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _LCD_FONT_H
+#define _LCD_FONT_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/** @defgroup LCD_FONT_Exported_Constants LCD Font Exported Constants
+ * @{
+ */
+#define LCD_FONT_PATH "/littlefs/gbk16.fnt"
+
+/* Page cache: LCD_FONT_PAGES pages of LCD_FONT_PAGE_SIZE bytes */
+#ifndef LCD_FONT_PAGE_SIZE
+#define LCD_FONT_PAGE_SIZE 256U
+#endif
+#ifndef LCD_FONT_PAGES
+#define LCD_FONT_PAGES 4U
+#endif
+  /**
+   * @}
+   */
+
+  /** @defgroup LCD_FONT_Exported_Types LCD Font Exported Types
+   * @{
+   */
+  typedef struct
+  {
+    uint32_t Lookups;    /* Characters asked for */
+    uint32_t Found;      /* Characters the font has */
+    uint32_t PageHits;   /* Page reads served from RAM */
+    uint32_t PageMisses; /* Page reads from the file */
+    uint32_t Cycles;     /* CPU cycles spent in lookups */
+  } LCD_FontStats_t;
+  /**
+   * @}
+   */
+
+  /** @defgroup LCD_FONT_Exported_Functions LCD Font Exported Functions
+   * @{
+   */
+  int32_t LCD_FontOpen(const char *Path);
+  void LCD_FontClose(void);
+  void LCD_FontFlush(void);
+  int32_t LCD_FontGetStats(LCD_FontStats_t *Stats);
+  /**
+   * @}
+   */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _LCD_FONT_H */
@@ -0,0 +1,110 @@
+/**
+ ******************************************************************************
+ * @file    spi_bus.h
+ * @brief   This file contains the defines and functions prototypes of the
+ *          HSPI bus arbiter shared by the LCD panels and other SPI devices.
+ ******************************************************************************
+ * @attention
+ *
+ * Every device on the bus gets a handle from SPI_BUS_AddDevice() and brackets
+ * its transfers with SPI_BUS_Acquire() / SPI_BUS_Release(). Waiting devices are
+ * granted the bus by priority, first come first served among equals, so a short
+ * high-priority transfer (touch sampling) goes out between two display flushes
+ * instead of after a whole frame. The clock divider, SPI mode and CS line of
+ * the device are set up when the bus changes hands, nothing is done while one
+ * device keeps using it.
+ *
+ * A device holding the bus for a background transfer releases it from the
+ * interrupt with SPI_BUS_ReleaseFromISR().
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _SPI_BUS_H
+#define _SPI_BUS_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "driver/spi.h"
+#include "lcd.h"
+
+/** @defgroup SPI_BUS_Exported_Constants SPI Bus Exported Constants
+ * @{
+ */
+#ifndef SPI_BUS_DEVICES_MAX
+#define SPI_BUS_DEVICES_MAX 4U
+#endif
+
+/* The HSPI hardware CS only reaches GPIO15 and toggles on every transaction,
+   those of the other devices included: the panels get a software CS driven by
+   the arbiter. Set it to 0 only when a single panel is the only device on the
+   bus, SPI_BUS_AddDevice() then refuses any other device */
+#ifndef SPI_BUS_SOFT_CS
+#define SPI_BUS_SOFT_CS 1
+#endif
+#if !SPI_BUS_SOFT_CS && (LCD_INSTANCES_NBR > 1U)
+#error "Several panels on the bus need SPI_BUS_SOFT_CS"
+#endif
+
+#define SPI_BUS_CS_NONE 0xFFU /* CS not driven by the arbiter: hardware CS or tied low */
+
+#define SPI_BUS_PRIO_LOW 0U  /* Bulk transfers: display flushes */
+#define SPI_BUS_PRIO_NORMAL 1U
+#define SPI_BUS_PRIO_HIGH 2U /* Short latency-sensitive transfers: touch sampling */
+  /**
+   * @}
+   */
+
+  /** @defgroup SPI_BUS_Exported_Types SPI Bus Exported Types
+   * @{
+   */
+  typedef struct
+  {
+    const char *Name;
+    spi_clk_div_t ClkDiv;
+    uint8_t Mode;     /* SPI mode 0-3: CPOL << 1 | CPHA */
+    uint8_t CsPin;    /* GPIO held low while the device has the bus, or SPI_BUS_CS_NONE */
+    uint8_t Priority; /* SPI_BUS_PRIO_LOW .. SPI_BUS_PRIO_HIGH */
+  } SPI_BUS_DevConfig_t;
+
+  typedef struct
+  {
+    uint32_t Acquires;     /* Transfers that got the bus */
+    uint32_t Contended;    /* Of them, queued behind another device */
+    uint32_t MaxWaitUs;    /* Longest time queued */
+    uint64_t WaitUs;       /* Time spent queued */
+    uint32_t Transactions; /* HSPI transactions */
+    uint64_t Bytes;        /* Bytes shifted out or in */
+    uint64_t WireCycles;   /* 80 MHz cycles the bus was shifting them */
+  } SPI_BUS_Stats_t;
+  /**
+   * @}
+   */
+
+  /** @defgroup SPI_BUS_Exported_Functions SPI Bus Exported Functions
+   * @{
+   */
+  int32_t SPI_BUS_AddDevice(const SPI_BUS_DevConfig_t *pConfig, uint32_t *pHandle);
+  uint32_t SPI_BUS_GetDevices(void);
+  int32_t SPI_BUS_GetConfig(uint32_t Handle, SPI_BUS_DevConfig_t *pConfig);
+  int32_t SPI_BUS_GetStats(uint32_t Handle, SPI_BUS_Stats_t *pStats);
+
+  int32_t SPI_BUS_Acquire(uint32_t Handle);
+  void SPI_BUS_Release(uint32_t Handle);
+  void SPI_BUS_ReleaseFromISR(uint32_t Handle);
+  void SPI_BUS_Account(uint32_t Bytes);
+  int32_t SPI_BUS_Transfer(uint32_t Handle, spi_trans_t *pTrans);
+  /**
+   * @}
+   */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SPI_BUS_H */
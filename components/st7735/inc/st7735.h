@@ -32,6 +32,7 @@ extern "C"
 #include <string.h>
 #include "lcd.h"
 #include "st7735_reg.h"
+#include "st7735_panel.h"
 
 #ifndef UNUSED
 #define UNUSED(x) ((void)(x))
@@ -70,14 +71,47 @@ extern "C"
     ST7735_ReadReg_Func ReadReg;
     ST7735_SendData_Func SendData;
     ST7735_RecvData_Func RecvData;
+    ST7735_SendData_Func SendPixels;
+    ST7735_SendData_Func SendPixelsAsync;
+    ST7735_SendData_Func FillPixels;
     ST7735_GetTick_Func GetTick;
     ST7735_Delay_Func Delay;
   } ST7735_IO_t;
 
+  /* Panel state, one per ST7735_Object_t so several panels can share the driver */
+  typedef struct
+  {
+    uint32_t Width;
+    uint32_t Height;
+    uint32_t Orientation;
+    /* RAM offset of the glass in this orientation and the first frame memory
+       row it shows, from the panel profile */
+    uint32_t XOffset;
+    uint32_t YOffset;
+    uint32_t RowStart;
+    /* Address window last sent to the panel, CASET/RASET are skipped when unchanged */
+    uint32_t XStart;
+    uint32_t XEnd;
+    uint32_t YStart;
+    uint32_t YEnd;
+    uint8_t ColumnValid;
+    uint8_t RowValid;
+    /* Window statistics */
+    uint32_t Windows;
+    uint32_t WindowTransfers;
+    /* Vertical scroll area in frame memory rows, ScrollVsa = 0: not defined */
+    uint32_t ScrollTfa;
+    uint32_t ScrollVsa;
+    /* ST7735_POWER_NORMAL, _IDLE or _PARTIAL, and the refresh rate in Hz */
+    uint32_t PowerMode;
+    uint32_t FrameRate;
+  } ST7735_Ctx_t;
+
   typedef struct
   {
     ST7735_IO_t IO;
     st7735_ctx_t Ctx;
+    ST7735_Ctx_t Panel;
     uint8_t IsInitialized;
   } ST7735_Object_t;
 
@@ -132,10 +166,20 @@ extern "C"
 #define ST7735_ID 0x5CU
 
 /**
- * @brief  ST7735 Size
+ * @brief  ST7735 Size, in portrait, from the panel profile
+ */
+#define ST7735_WIDTH ST7735_PANEL_WIDTH
+#define ST7735_HEIGHT ST7735_PANEL_HEIGHT
+
+/**
+ *  @brief  Glyph cache: RAM for ASCII glyphs kept expanded to RGB565, 0 disables it
  */
-#define ST7735_WIDTH 128U
-#define ST7735_HEIGHT 160U
+#ifndef ST7735_GLYPH_CACHE_SIZE
+#define ST7735_GLYPH_CACHE_SIZE 4096U
+#endif
+#ifndef ST7735_GLYPH_CACHE_ENTRIES
+#define ST7735_GLYPH_CACHE_ENTRIES 24U
+#endif
 
 /**
  *  @brief LCD_OrientationTypeDef
@@ -153,6 +197,13 @@ extern "C"
 #define ST7735_FORMAT_RBG565 0x05U /* Pixel format chosen is RGB565 : 16 bpp */
 #define ST7735_FORMAT_RBG666 0x06U /* Pixel format chosen is RGB666 : 18 bpp */
 #define ST7735_FORMAT_DEFAULT ST7735_FORMAT_RBG565
+
+/**
+ *  @brief  Display modes, see ST7735_SetPowerMode()
+ */
+#define ST7735_POWER_NORMAL 0x00U  /* Whole display, full colors                  */
+#define ST7735_POWER_IDLE 0x01U    /* Whole display, 8 colors: MSB of each channel */
+#define ST7735_POWER_PARTIAL 0x02U /* Only a band of lines driven, full colors    */
 /**
  * @}
  */
@@ -169,6 +220,8 @@ extern "C"
   int32_t ST7735_RegisterBusIO(ST7735_Object_t *pObj, ST7735_IO_t *pIO);
   int32_t ST7735_Init(ST7735_Object_t *pObj, uint32_t ColorCoding, uint32_t Orientation);
   int32_t ST7735_DeInit(ST7735_Object_t *pObj);
+  int32_t ST7735_Sleep(ST7735_Object_t *pObj);
+  int32_t ST7735_Resume(ST7735_Object_t *pObj, uint32_t ColorCoding, uint32_t Orientation);
   int32_t ST7735_ReadID(ST7735_Object_t *pObj, uint32_t *Id);
   int32_t ST7735_DisplayOn(ST7735_Object_t *pObj);
   int32_t ST7735_DisplayOff(ST7735_Object_t *pObj);
@@ -178,11 +231,24 @@ extern "C"
   int32_t ST7735_GetOrientation(ST7735_Object_t *pObj, uint32_t *Orientation);
 
   int32_t ST7735_SetCursor(ST7735_Object_t *pObj, uint32_t Start_Xpos, uint32_t Start_Ypos, uint32_t End_Xpos, uint32_t End_Ypos);
+  int32_t ST7735_SetColorCoding(ST7735_Object_t *pObj, uint32_t ColorCoding);
+  int32_t ST7735_SetScrollArea(ST7735_Object_t *pObj, uint32_t Top, uint32_t Bottom);
+  int32_t ST7735_SetScrollOffset(ST7735_Object_t *pObj, uint32_t Offset);
+  int32_t ST7735_SetPowerMode(ST7735_Object_t *pObj, uint32_t Mode, uint32_t Start, uint32_t End);
+  int32_t ST7735_SetFrameRate(ST7735_Object_t *pObj, uint32_t Rate);
+  int32_t ST7735_GetFrameRate(ST7735_Object_t *pObj, uint32_t *Rate);
+  int32_t ST7735_GetWindowStats(ST7735_Object_t *pObj, uint32_t *Windows, uint32_t *Transfers);
+  int32_t ST7735_GetGlyphCacheStats(ST7735_Object_t *pObj, uint32_t *Hits, uint32_t *Misses);
+  int32_t ST7735_GetWideGlyph(const uint8_t *pCode, uint8_t size, const uint8_t **pBits, uint32_t *Width);
   int32_t ST7735_DrawBitmap(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint32_t width, uint32_t height, uint8_t *pBmp);
+  int32_t ST7735_DrawBitmapAsync(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint32_t width, uint32_t height, uint8_t *pBmp);
   int32_t ST7735_FillRGBRect(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint8_t *pData, uint32_t Width, uint32_t Height);
+  int32_t ST7735_FillRGBRectStride(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint8_t *pData, uint32_t Width, uint32_t Height, uint32_t Stride);
+  int32_t ST7735_FillRGBRectStrideAsync(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint8_t *pData, uint32_t Width, uint32_t Height, uint32_t Stride);
   int32_t ST7735_DrawHLine(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint32_t Length, uint32_t Color);
   int32_t ST7735_DrawVLine(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint32_t Length, uint32_t Color);
   int32_t ST7735_FillRect(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint32_t Width, uint32_t Height, uint32_t Color);
+  int32_t ST7735_DrawRect(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint32_t Width, uint32_t Height, uint32_t Color);
   int32_t ST7735_SetPixel(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint32_t Color);
   int32_t ST7735_GetPixel(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint32_t *Color);
   int32_t ST7735_DrawChar(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint8_t num, uint8_t size, uint32_t fColor, uint32_t bColor, uint8_t mode);
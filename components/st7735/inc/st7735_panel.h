@@ -0,0 +1,193 @@
+/**
+ ******************************************************************************
+ * @file    st7735_panel.h
+ * @brief   Compile-time panel profiles for the st7735.c driver and the LVGL
+ *          port: resolution, RAM offsets, MADCTL table, colour order and
+ *          init sequence of the glass wired to the controller.
+ ******************************************************************************
+ * @attention
+ *
+ * ST7735_PANEL selects one of the built-in profiles below. A new variant is
+ * added without touching the driver by putting its macros in a header of its
+ * own and building with -DST7735_PANEL_PROFILE="\"my_panel.h\"". A profile
+ * defines:
+ *
+ *   ST7735_PANEL_WIDTH      Width in portrait, in pixels
+ *   ST7735_PANEL_HEIGHT     Height in portrait, in pixels
+ *   ST7735_PANEL_COL_START  First RAM column shown in portrait
+ *   ST7735_PANEL_ROW_START  First RAM row shown in portrait
+ *   ST7735_PANEL_OFFSETS    {X, Y} RAM offset per ST7735_ORIENTATION_xxx (optional)
+ *   ST7735_PANEL_MADCTL     MADCTL per ST7735_ORIENTATION_xxx without the colour
+ *                           order bit (optional)
+ *   ST7735_PANEL_COLOR_ORDER ST7735_PANEL_RGB or ST7735_PANEL_BGR
+ *   ST7735_PANEL_INIT_CMDS  Init table bytes, see ST7735_SendInitTable() for
+ *                           the format. COLMOD, MADCTL and DISPON are sent by
+ *                           ST7735_Init().
+ *   ST7735_PANEL_CONTROLLER ST7735_CONTROLLER_xxx driving the glass (optional)
+ *   ST7735_PANEL_FRAME_ROWS Frame memory rows of the controller (optional)
+ *   ST7735_PANEL_FRAME_RATE Refresh rate in Hz the init table sets (optional)
+ *
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef ST7735_PANEL_H
+#define ST7735_PANEL_H
+
+/**
+ *  @brief  Built-in panel variants, ST7735_PANEL selects one of them
+ */
+#define ST7735_PANEL_128X160 0U         /* 1.8" 128x160 panel                        */
+#define ST7735_PANEL_GREENTAB_80X160 1U /* 0.96" 80x160 GREENTAB, inverted IPS glass */
+#define ST7735_PANEL_ST7789_240X240 2U  /* 1.3" 240x240 IPS on an ST7789               */
+#define ST7735_PANEL_ST7789_240X320 3U  /* 2.0" 240x320 IPS on an ST7789V              */
+#ifndef ST7735_PANEL
+#define ST7735_PANEL ST7735_PANEL_128X160
+#endif
+
+/**
+ *  @brief  Controllers, they share the MIPI DCS command set and the st7735.c
+ *          drawing code, see st7789.h
+ */
+#define ST7735_CONTROLLER_ST7735 0U
+#define ST7735_CONTROLLER_ST7789 1U
+
+/**
+ *  @brief  Colour order bit of MADCTL and the delay flag of the init tables
+ */
+#define ST7735_PANEL_RGB 0x00U
+#define ST7735_PANEL_BGR 0x08U
+#define ST7735_INIT_DELAY 0x80U
+
+/* Common part of the init sequence: frame rate 59 Hz in every mode, power
+   control and VCOM as recommended for the 1.8" glass */
+#define ST7735_PANEL_INIT_POWER                                                   \
+  ST7735_SLEEP_OUT, ST7735_INIT_DELAY, 5U,                                        \
+  ST7735_FRAME_RATE_CTRL1, 3U, 0x01U, 0x2CU, 0x2DU,                               \
+  ST7735_FRAME_RATE_CTRL2, 3U, 0x01U, 0x2CU, 0x2DU,                               \
+  ST7735_FRAME_RATE_CTRL3, 6U, 0x01U, 0x2CU, 0x2DU, 0x01U, 0x2CU, 0x2DU,          \
+  ST7735_FRAME_INVERSION_CTRL, 1U, 0x07U,                                         \
+  ST7735_PWR_CTRL1, 3U, 0xA2U, 0x02U, 0x84U,                                      \
+  ST7735_PWR_CTRL2, 1U, 0xC5U,                                                    \
+  ST7735_PWR_CTRL3, 2U, 0x0AU, 0x00U,                                             \
+  ST7735_PWR_CTRL4, 2U, 0x8AU, 0x2AU,                                             \
+  ST7735_PWR_CTRL5, 2U, 0x8AU, 0xEEU,                                             \
+  ST7735_VCOMH_VCOML_CTRL1, 1U, 0x0EU
+
+#if defined(ST7735_PANEL_PROFILE)
+#include ST7735_PANEL_PROFILE
+
+#elif (ST7735_PANEL == ST7735_PANEL_ST7789_240X240) || (ST7735_PANEL == ST7735_PANEL_ST7789_240X320)
+/* ST7789 IPS glass: 240 x 320 frame memory, scanned at 60 Hz with 12-line
+   porches. A 240x240 glass shows the first 240 rows, so the rotations that
+   count the rows from the other end skip the 80 rows it does not have */
+#define ST7735_PANEL_CONTROLLER ST7735_CONTROLLER_ST7789
+#define ST7735_PANEL_FRAME_ROWS 320U
+#define ST7735_PANEL_FRAME_RATE 59U
+#define ST7735_PANEL_WIDTH 240U
+#if (ST7735_PANEL == ST7735_PANEL_ST7789_240X240)
+#define ST7735_PANEL_HEIGHT 240U
+#else
+#define ST7735_PANEL_HEIGHT 320U
+#endif
+#define ST7735_PANEL_COL_START 0U
+#define ST7735_PANEL_ROW_START 0U
+#define ST7735_PANEL_COLOR_ORDER ST7735_PANEL_RGB
+#define ST7735_PANEL_MADCTL {0x00U, 0xC0U, 0x60U, 0xA0U}
+#define ST7735_PANEL_OFFSETS                                                      \
+  {                                                                               \
+    {0U, 0U},                                                                     \
+    {0U, 320U - ST7735_PANEL_HEIGHT},                                             \
+    {0U, 0U},                                                                     \
+    {320U - ST7735_PANEL_HEIGHT, 0U},                                             \
+  }
+#define ST7735_PANEL_INIT_CMDS                                                    \
+  14U,                                                                            \
+  ST7735_SLEEP_OUT, ST7735_INIT_DELAY, 120U,                                      \
+  ST7789_PORCTRL, 5U, 0x0CU, 0x0CU, 0x00U, 0x33U, 0x33U,                          \
+  ST7789_GCTRL, 1U, 0x35U,                                                        \
+  ST7789_VCOMS, 1U, 0x19U,                                                        \
+  ST7789_LCMCTRL, 1U, 0x2CU,                                                      \
+  ST7789_VDVVRHEN, 2U, 0x01U, 0xFFU,                                              \
+  ST7789_VRHS, 1U, 0x12U,                                                         \
+  ST7789_VDVS, 1U, 0x20U,                                                         \
+  ST7789_FRCTRL2, 1U, 0x0FU,                                                      \
+  ST7789_PWCTRL1, 2U, 0xA4U, 0xA1U,                                               \
+  ST7735_PV_GAMMA_CTRL, 14U, 0xD0U, 0x04U, 0x0DU, 0x11U, 0x13U, 0x2BU, 0x3FU,     \
+  0x54U, 0x4CU, 0x18U, 0x0DU, 0x0BU, 0x1FU, 0x23U,                                \
+  ST7735_NV_GAMMA_CTRL, 14U, 0xD0U, 0x04U, 0x0CU, 0x11U, 0x13U, 0x2CU, 0x3FU,     \
+  0x44U, 0x51U, 0x2FU, 0x1FU, 0x1FU, 0x20U, 0x23U,                                \
+  ST7735_DISPLAY_INVERSION_ON, 0U,                                                \
+  ST7735_NORMAL_DISPLAY_OFF, ST7735_INIT_DELAY, 10U
+
+#elif (ST7735_PANEL == ST7735_PANEL_GREENTAB_80X160)
+/* 0.96" 80x160 GREENTAB (M5StickC): the glass sits in the middle of the 132
+   RAM columns, BGR filter and inverted IPS glass */
+#define ST7735_PANEL_WIDTH 80U
+#define ST7735_PANEL_HEIGHT 160U
+#define ST7735_PANEL_COL_START 26U
+#define ST7735_PANEL_ROW_START 1U
+#define ST7735_PANEL_COLOR_ORDER ST7735_PANEL_BGR
+#define ST7735_PANEL_INIT_CMDS                                                    \
+  17U,                                                                            \
+  ST7735_PANEL_INIT_POWER,                                                        \
+  ST7735_DISPLAY_INVERSION_ON, 0U,                                                \
+  ST7735_PV_GAMMA_CTRL, 16U, 0x02U, 0x1CU, 0x07U, 0x12U, 0x37U, 0x32U, 0x29U,     \
+  0x2DU, 0x29U, 0x25U, 0x2BU, 0x39U, 0x00U, 0x01U, 0x03U, 0x10U,                  \
+  ST7735_NV_GAMMA_CTRL, 16U, 0x03U, 0x1DU, 0x07U, 0x06U, 0x2EU, 0x2CU, 0x29U,     \
+  0x2DU, 0x2EU, 0x2EU, 0x37U, 0x3FU, 0x00U, 0x00U, 0x02U, 0x10U,                  \
+  ST7735_EXT_CTRL, 1U, 0x01U,                                                     \
+  0xF6U, 1U, 0x00U,                                                               \
+  ST7735_NORMAL_DISPLAY_OFF, ST7735_INIT_DELAY, 10U
+
+#else
+/* 1.8" 128x160: 2 spare columns and 1 spare row on each side of the glass */
+#define ST7735_PANEL_WIDTH 128U
+#define ST7735_PANEL_HEIGHT 160U
+#define ST7735_PANEL_COL_START 2U
+#define ST7735_PANEL_ROW_START 1U
+#define ST7735_PANEL_COLOR_ORDER ST7735_PANEL_RGB
+#define ST7735_PANEL_INIT_CMDS                                                    \
+  17U,                                                                            \
+  ST7735_PANEL_INIT_POWER,                                                        \
+  ST7735_DISPLAY_INVERSION_OFF, 0U,                                               \
+  ST7735_PV_GAMMA_CTRL, 16U, 0x0FU, 0x1AU, 0x0FU, 0x18U, 0x2FU, 0x28U, 0x20U,     \
+  0x22U, 0x1FU, 0x1BU, 0x23U, 0x37U, 0x00U, 0x07U, 0x02U, 0x10U,                  \
+  ST7735_NV_GAMMA_CTRL, 16U, 0x0FU, 0x1BU, 0x0FU, 0x17U, 0x33U, 0x2CU, 0x29U,     \
+  0x2EU, 0x30U, 0x30U, 0x39U, 0x3FU, 0x00U, 0x07U, 0x03U, 0x10U,                  \
+  ST7735_EXT_CTRL, 1U, 0x01U,                                                     \
+  0xF6U, 1U, 0x00U,                                                               \
+  ST7735_NORMAL_DISPLAY_OFF, 0U
+#endif
+
+/* Defaults a profile may leave out: the glass is centred in the frame memory,
+   so a 180 degree rotation keeps the offsets and landscape swaps them */
+#ifndef ST7735_PANEL_OFFSETS
+#define ST7735_PANEL_OFFSETS                                 \
+  {                                                          \
+    {ST7735_PANEL_COL_START, ST7735_PANEL_ROW_START},        \
+    {ST7735_PANEL_COL_START, ST7735_PANEL_ROW_START},        \
+    {ST7735_PANEL_ROW_START, ST7735_PANEL_COL_START},        \
+    {ST7735_PANEL_ROW_START, ST7735_PANEL_COL_START},        \
+  }
+#endif
+#ifndef ST7735_PANEL_MADCTL
+#define ST7735_PANEL_MADCTL {0xC0U, 0x00U, 0x60U, 0xA0U}
+#endif
+#ifndef ST7735_PANEL_CONTROLLER
+#define ST7735_PANEL_CONTROLLER ST7735_CONTROLLER_ST7735
+#endif
+#ifndef ST7735_PANEL_FRAME_ROWS
+#define ST7735_PANEL_FRAME_ROWS 162U /* ST7735 with GM = 11: 132 x 162 */
+#endif
+#ifndef ST7735_PANEL_FRAME_RATE
+#define ST7735_PANEL_FRAME_RATE 59U /* FRMCTR 0x01, 0x2C, 0x2D */
+#endif
+
+#if !defined(ST7735_PANEL_WIDTH) || !defined(ST7735_PANEL_HEIGHT) ||         \
+    !defined(ST7735_PANEL_COL_START) || !defined(ST7735_PANEL_ROW_START) ||  \
+    !defined(ST7735_PANEL_COLOR_ORDER) || !defined(ST7735_PANEL_INIT_CMDS)
+#error "st7735_panel.h: incomplete panel profile"
+#endif
+
+#endif /* ST7735_PANEL_H */
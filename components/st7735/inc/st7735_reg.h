@@ -73,9 +73,11 @@ extern "C"
 #define ST7735_RGBSET 0x2DU                /* LUT for 4k,65k,262k color: RGBSET           */
 #define ST7735_READ_RAM 0x2EU              /* Memory read: RAMRD                          */
 #define ST7735_PTLAR 0x30U                 /* Partial start/end address set: PTLAR        */
+#define ST7735_VSCRDEF 0x33U               /* Vertical scrolling definition: VSCRDEF      */
 #define ST7735_TE_LINE_OFF 0x34U           /* Tearing effect line off: TEOFF              */
 #define ST7735_TE_LINE_ON 0x35U            /* Tearing effect mode set & on: TEON          */
 #define ST7735_MADCTL 0x36U                /* Memory data access control: MADCTL          */
+#define ST7735_VSCRSADD 0x37U              /* Vertical scrolling start address: VSCRSADD  */
 #define ST7735_IDLE_MODE_OFF 0x38U         /* Idle mode off: IDMOFF                       */
 #define ST7735_IDLE_MODE_ON 0x39U          /* Idle mode on: IDMON                         */
 #define ST7735_COLOR_MODE 0x3AU            /* Interface pixel format: COLMOD              */
@@ -105,6 +107,18 @@ extern "C"
 #define ST7735_PWR_CTRL6 0xFCU             /* In partial mode + Idle mode: PWCTR6         */
 #define ST7735_VCOM4_LEVEL 0xFFU           /* VCOM 4 level control                        */
 
+/* ST7789 commands that differ from the ST7735 ones at the same address */
+#define ST7789_PORCTRL 0xB2U               /* Porch setting: PORCTRL                      */
+#define ST7789_FRCTRL1 0xB3U               /* Frame rate control in idle/partial: FRCTRL1 */
+#define ST7789_GCTRL 0xB7U                 /* Gate control: GCTRL                         */
+#define ST7789_VCOMS 0xBBU                 /* VCOM setting: VCOMS                         */
+#define ST7789_LCMCTRL 0xC0U               /* LCM control: LCMCTRL                        */
+#define ST7789_VDVVRHEN 0xC2U              /* VDV and VRH command enable: VDVVRHEN        */
+#define ST7789_VRHS 0xC3U                  /* VRH set: VRHS                               */
+#define ST7789_VDVS 0xC4U                  /* VDV set: VDVS                               */
+#define ST7789_FRCTRL2 0xC6U               /* Frame rate control in normal mode: FRCTRL2  */
+#define ST7789_PWCTRL1 0xD0U               /* Power control 1: PWCTRL1                    */
+
   /**
    * @}
    */
@@ -123,6 +137,9 @@ extern "C"
     ST7735_Read_Func ReadReg;
     ST7735_Send_Func SendData;
     ST7735_Recv_Func RecvData;
+    ST7735_Send_Func SendPixels;
+    ST7735_Send_Func SendPixelsAsync;
+    ST7735_Send_Func FillPixels;
     void *handle;
   } st7735_ctx_t;
 
@@ -137,6 +154,9 @@ extern "C"
   int32_t st7735_read_reg(st7735_ctx_t *ctx, uint8_t reg, uint8_t *pdata);
   int32_t st7735_send_data(st7735_ctx_t *ctx, uint8_t *pdata, uint32_t length);
   int32_t st7735_recv_data(st7735_ctx_t *ctx, uint8_t *pdata, uint32_t length);
+  int32_t st7735_send_pixels(st7735_ctx_t *ctx, uint8_t *pdata, uint32_t length);
+  int32_t st7735_send_pixels_async(st7735_ctx_t *ctx, uint8_t *pdata, uint32_t length);
+  int32_t st7735_fill_pixels(st7735_ctx_t *ctx, uint8_t *pdata, uint32_t length);
 
   /**
    * @}
@@ -38,9 +38,10 @@ extern "C"
 // and are modified to fit to the M5StickC device, and are taken from
 //      https://github.com/adafruit/Adafruit-ST7735-Library
 //
-#define ST7735_GREENTAB160x80 // For 160 x 80 display (BGR, inverted, 26 / 1 offset)
-#define COLSTART 26
-#define ROWSTART 1
+// Offsets come from the panel profile, see st7735_panel.h
+#include "st7735_panel.h"
+#define COLSTART ST7735_PANEL_COL_START
+#define ROWSTART ST7735_PANEL_ROW_START
 
 // Delay between some initialisation commands
 #define TFT_INIT_DELAY 0x80
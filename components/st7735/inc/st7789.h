@@ -0,0 +1,83 @@
+/**
+ ******************************************************************************
+ * @file    st7789.h
+ * @brief   This file contains all the functions prototypes for the st7789.c
+ *          driver.
+ ******************************************************************************
+ * @attention
+ *
+ * The ST7789 speaks the same MIPI DCS command set as the ST7735: address
+ * window, pixel stream, MADCTL, scrolling, partial and idle modes, sleep.
+ * Its driver therefore runs on an ST7735_Object_t and reuses the st7735.c
+ * drawing code with its window cache, burst and background transfers, and
+ * only replaces what the controller does differently. Select it with an
+ * ST7789 panel profile, see st7735_panel.h.
+ *
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef ST7789_H
+#define ST7789_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "st7735.h"
+
+  /** @addtogroup BSP
+   * @{
+   */
+
+  /** @addtogroup Components
+   * @{
+   */
+
+  /** @defgroup ST7789 ST7789
+   * @{
+   */
+
+/** @defgroup ST7789_Exported_Constants Exported Constants
+ * @{
+ */
+
+/**
+ * @brief  ST7789 ID, RDID1
+ */
+#define ST7789_ID 0x85U
+
+/**
+ * @}
+ */
+
+  /** @defgroup ST7789_Exported_Functions Exported Functions
+   * @{
+   */
+  int32_t ST7789_SetFrameRate(ST7735_Object_t *pObj, uint32_t Rate);
+
+  extern ST7735_LCD_Drv_t ST7789_LCD_Driver;
+
+  /**
+   * @}
+   */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ST7789_H */
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
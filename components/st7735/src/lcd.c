@@ -1,17 +1,131 @@
 #include "lcd.h"
 #include "st7735.h"
+#include "st7789.h"
+#include "spi_bus.h"
+#include "lcd_fifo.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/spi.h"
 #include "esp_attr.h"
+#include "esp8266/spi_struct.h"
+#include "esp8266/gpio_struct.h"
+#include "sdkconfig.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/** @defgroup ADAFRUIT_802_LCD_Private_Defines LCD Private Defines
+ * @{
+ */
+#define LCD_SPI_HOST HSPI_HOST
+#define LCD_SPI_FIFO_SIZE LCD_FIFO_SIZE
+
+/* The panel takes RGB565 high byte first. Unless LVGL already renders swapped
+   colors, the bytes of each pixel are exchanged while the FIFO is packed */
+#if defined(CONFIG_LV_COLOR_16_SWAP)
+#define LCD_IO_SWAP_PIXELS 0
+#else
+#define LCD_IO_SWAP_PIXELS 1
+#endif
+
+/* RGB444 pixels per FIFO: 60 bytes, five 8-pixel packing kernels */
+#define LCD_IO_PACK_PIXELS 40U
+
+/* Every panel is a device of the HSPI bus arbiter. Display flushes are bulk
+   transfers, other devices of higher priority go out between two of them */
+#define LCD_SPI_CLK_DIV SPI_40MHz_DIV
+#define LCD_SPI_MODE 3U
+
+#if (LCD_INSTANCES_NBR > 2U)
+#error "LCD_INSTANCES_NBR: at most 2 panels are wired"
+#endif
+
+#define LCD_RESUME_MAGIC 0x4C435352U /* "LCSR" */
+/**
+ * @}
+ */
+
+/** @defgroup ADAFRUIT_802_LCD_Private_Types LCD Private Types
+ * @{
+ */
+typedef struct
+{
+  const uint8_t *pData;  /* Next pixels to be loaded into the FIFO */
+  uint32_t Length;       /* Bytes left to be loaded */
+  uint32_t Instance;     /* Instance reported to LCD_SignalTransferDone() */
+  volatile uint8_t Busy; /* A background transfer owns the bus */
+  volatile uint8_t Held; /* Inside an IO call, which releases the bus itself */
+} LCD_IO_Async_t;
+
+typedef struct
+{
+  uint8_t Enabled; /* Pixels go out as RGB444, two in three bytes */
+  uint8_t Dither;  /* Ordered dithering of the pixel streams */
+  uint8_t Stream;  /* RAMWR data phase: SendData() carries pixels */
+  uint8_t Pending; /* Carry waits for the second pixel of its pair */
+  uint16_t Carry;
+  /* Address window seen on the bus and the dithering position in it */
+  uint16_t XStart;
+  uint16_t XEnd;
+  uint16_t YStart;
+  uint16_t X;
+  uint16_t Y;
+} LCD_IO_Pack_t;
+
+typedef struct
+{
+  uint32_t Instance;
+  uint32_t CsPin;
+  uint32_t DcPin;
+  uint32_t BusDev;   /* SPI_BUS_AddDevice() handle */
+  uint8_t OnBus;
+  volatile uint32_t Transactions; /* SPI transactions of this panel */
+  LCD_IO_Pack_t Pack;
+  const uint16_t *pLut; /* Bitmaps are 8-bit indices into it, NULL: RGB565 */
+} LCD_IO_Dev_t;
+
+/* Panel state kept in RTC memory across deep sleep, see LCD_Sleep() */
+typedef struct
+{
+  uint32_t Magic;
+  uint32_t Orientation;
+  uint32_t FrameRate;
+  uint32_t ScrollTop;
+  uint32_t ScrollHeight;
+  uint32_t ScrollOffset;
+  uint32_t Checksum;
+} LCD_Resume_t;
+/**
+ * @}
+ */
 
 /** @defgroup ADAFRUIT_802_LCD_Private_Variables LCD Private Variables
  * @{
  */
-static ST7735_Object_t ST7735Obj;
-static void *Lcd_CompObj = &ST7735Obj;
+static ST7735_Object_t ST7735Obj[LCD_INSTANCES_NBR];
+/* Controller of the configured panel profile, see st7735_panel.h */
+#if (ST7735_PANEL_CONTROLLER == ST7735_CONTROLLER_ST7789)
+static LCD_Drv_t *Lcd = &ST7789_LCD_Driver.Lcd;
+#else
 static LCD_Drv_t *Lcd = &ST7735_LCD_Driver.Lcd;
+#endif
 LCD_Ctx_t Lcd_Ctx[LCD_INSTANCES_NBR];
+static LCD_IO_Async_t Lcd_Async;
+static uint8_t Lcd_DcLevel = 0xFFU; /* Level last driven on D/C, 0xFF: unknown */
+static LCD_IO_Dev_t Lcd_Dev[LCD_INSTANCES_NBR] = {
+    {.Instance = 0U, .CsPin = LCD_CS_PIN, .DcPin = LCD_DC_PIN},
+#if (LCD_INSTANCES_NBR > 1U)
+    {.Instance = 1U, .CsPin = LCD1_CS_PIN, .DcPin = LCD1_DC_PIN},
+#endif
+};
+static LCD_IO_Dev_t *Lcd_Io; /* Panel owning the bus, NULL: none selected yet */
+static RTC_DATA_ATTR LCD_Resume_t Lcd_Resume[LCD_INSTANCES_NBR];
+
+/* 4x4 Bayer matrix, read from the SPI interrupt */
+static const DRAM_ATTR uint8_t Lcd_Bayer[16] = {
+    0U, 8U, 2U, 10U,
+    12U, 4U, 14U, 6U,
+    3U, 11U, 1U, 9U,
+    15U, 7U, 13U, 5U};
 
 /**
  * @}
@@ -41,11 +155,29 @@ LCD_Ctx_t Lcd_Ctx[LCD_INSTANCES_NBR];
 /** @defgroup ADAFRUIT_802_LCD_Private_FunctionPrototypes LCD Private Function Prototypes
  * @{
  */
-static int32_t ST7735_Probe(uint32_t Orientation);
+static int32_t ST7735_Probe(uint32_t Instance, uint32_t Orientation);
+static int32_t LCD_IO_Attach(uint32_t Instance);
+static uint32_t LCD_ResumeChecksum(const LCD_Resume_t *pState);
 // static int32_t LCD_IO_Init(void);
 // static int32_t LCD_IO_DeInit(void);
+static void LCD_IO_Delay(uint32_t Delay);
 static int32_t LCD_IO_WriteReg(uint8_t Reg, uint8_t *pData, uint32_t Length);
 static int32_t LCD_IO_SendData(uint8_t *pData, uint32_t Length);
+static int32_t LCD_IO_SendPixels(uint8_t *pData, uint32_t Length);
+static int32_t LCD_IO_SendPixelsAsync(uint8_t *pData, uint32_t Length);
+static int32_t LCD_IO_FillPixels(uint8_t *pData, uint32_t Length);
+static int32_t LCD_IO_BusWriteReg(uint8_t Reg, uint8_t *pData, uint32_t Length);
+static int32_t LCD_IO_BusSendData(uint8_t *pData, uint32_t Length);
+static int32_t LCD_IO_BusSendPixels(uint8_t *pData, uint32_t Length);
+static int32_t LCD_IO_BusSendPixelsAsync(uint8_t *pData, uint32_t Length);
+static int32_t LCD_IO_BusFillPixels(uint8_t *pData, uint32_t Length);
+static inline void LCD_IO_WaitIdle(void);
+static int32_t LCD_IO_SendPixels444(const uint8_t **ppData, uint32_t Length, uint8_t BigEndian);
+static int32_t LCD_IO_FillPixels444(const uint8_t *pData, uint32_t Length);
+static void LCD_IO_FlushCarry(void);
+static void *LCD_IO_Select(uint32_t Instance);
+static void LCD_IO_Begin(void);
+static void LCD_IO_End(void);
 /**
  * @}
  */
@@ -74,7 +206,13 @@ int32_t LCD_Init(uint32_t Instance, uint32_t Orientation)
   }
   else
   {
-    if (ST7735_Probe(Orientation) != BSP_ERROR_NONE)
+    Lcd_Ctx[Instance].ScrollHeight = 0U;
+    Lcd_Ctx[Instance].PowerMode = LCD_POWER_MODE_NORMAL;
+    Lcd_Ctx[Instance].Resumed = 0U;
+    Lcd_Ctx[Instance].PixelFormat = LCD_PIXEL_FORMAT_RGB565;
+    Lcd_Dev[Instance].Pack.Enabled = 0U;
+    Lcd_Dev[Instance].Pack.Pending = 0U;
+    if (ST7735_Probe(Instance, Orientation) != BSP_ERROR_NONE)
     {
       ret = BSP_ERROR_UNKNOWN_COMPONENT;
     }
@@ -95,6 +233,119 @@ int32_t LCD_Init(uint32_t Instance, uint32_t Orientation)
   return ret;
 }
 
+/**
+ * @brief  Puts the panel to sleep before a deep sleep of the MCU.
+ * @note   The panel keeps its picture and its registers, the state the driver
+ *         needs to take it over again is saved in RTC memory: after waking,
+ *         LCD_Resume() replaces LCD_Init(). Leaves idle and partial mode first.
+ *         The RESET line must be held high by a pull-up while the MCU sleeps.
+ * @param  Instance LCD Instance
+ * @retval Error status
+ */
+int32_t LCD_Sleep(uint32_t Instance)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  LCD_Resume_t *state;
+
+  if (Instance >= LCD_INSTANCES_NBR)
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else if ((Lcd->Sleep == NULL) || (Lcd->GetOrientation == NULL) || (Lcd->GetFrameRate == NULL))
+  {
+    ret = BSP_ERROR_FEATURE_NOT_SUPPORTED;
+  }
+  else
+  {
+    state = &Lcd_Resume[Instance];
+    state->Magic = 0U;
+    if ((Lcd_Ctx[Instance].PowerMode != LCD_POWER_MODE_NORMAL) &&
+        (LCD_SetPowerMode(Instance, LCD_POWER_MODE_NORMAL, 0U, 0U) != BSP_ERROR_NONE))
+    {
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+    }
+    else if ((Lcd->GetOrientation(LCD_IO_Select(Instance), &state->Orientation) < 0) ||
+             (Lcd->GetFrameRate(LCD_IO_Select(Instance), &state->FrameRate) < 0) ||
+             (Lcd->Sleep(LCD_IO_Select(Instance)) < 0))
+    {
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+    }
+    else
+    {
+      state->ScrollTop = Lcd_Ctx[Instance].ScrollTop;
+      state->ScrollHeight = Lcd_Ctx[Instance].ScrollHeight;
+      state->ScrollOffset = Lcd_Ctx[Instance].ScrollOffset;
+      state->Magic = LCD_RESUME_MAGIC;
+      state->Checksum = LCD_ResumeChecksum(state);
+    }
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Takes over a panel put to sleep by LCD_Sleep(), instead of LCD_Init().
+ * @note   No reset, no init sequence and no clear: the panel is woken up and
+ *         shows its picture again within a few milliseconds. The saved state is
+ *         used once, the next deep sleep needs another LCD_Sleep().
+ * @param  Instance LCD Instance
+ * @retval BSP_ERROR_NO_INIT when there is no valid saved state: call LCD_Init()
+ */
+int32_t LCD_Resume(uint32_t Instance)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  LCD_Resume_t *state;
+
+  if (Instance >= LCD_INSTANCES_NBR)
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else if ((Lcd_Resume[Instance].Magic != LCD_RESUME_MAGIC) ||
+           (Lcd_Resume[Instance].Checksum != LCD_ResumeChecksum(&Lcd_Resume[Instance])) ||
+           (Lcd_Resume[Instance].Orientation > LCD_ORIENTATION_LANDSCAPE_ROT180))
+  {
+    ret = BSP_ERROR_NO_INIT;
+  }
+  else if (Lcd->Resume == NULL)
+  {
+    ret = BSP_ERROR_FEATURE_NOT_SUPPORTED;
+  }
+  else
+  {
+    state = &Lcd_Resume[Instance];
+    state->Magic = 0U;
+    Lcd_Ctx[Instance].ScrollHeight = 0U;
+    Lcd_Ctx[Instance].PowerMode = LCD_POWER_MODE_NORMAL;
+    Lcd_Ctx[Instance].PixelFormat = LCD_PIXEL_FORMAT_RGB565;
+    Lcd_Dev[Instance].Pack.Enabled = 0U;
+    Lcd_Dev[Instance].Pack.Pending = 0U;
+    if (LCD_IO_Attach(Instance) != BSP_ERROR_NONE)
+    {
+      ret = BSP_ERROR_BUS_FAILURE;
+    }
+    else if (Lcd->Resume(LCD_IO_Select(Instance), ST7735_FORMAT_DEFAULT, state->Orientation) < 0)
+    {
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+    }
+    else if ((LCD_GetXSize(Instance, &Lcd_Ctx[Instance].XSize) != BSP_ERROR_NONE) ||
+             (LCD_GetYSize(Instance, &Lcd_Ctx[Instance].YSize) != BSP_ERROR_NONE) ||
+             (LCD_SetFrameRate(Instance, state->FrameRate) != BSP_ERROR_NONE))
+    {
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+    }
+    else if ((state->ScrollHeight != 0U) &&
+             ((LCD_ScrollSetArea(Instance, state->ScrollTop,
+                                 Lcd_Ctx[Instance].YSize - state->ScrollTop - state->ScrollHeight) != BSP_ERROR_NONE) ||
+              (LCD_ScrollSetOffset(Instance, state->ScrollOffset) != BSP_ERROR_NONE)))
+    {
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+    }
+    Lcd_Ctx[Instance].Resumed = (ret == BSP_ERROR_NONE) ? 1U : 0U;
+  }
+
+  return ret;
+}
+
 /**
  * @brief  DeInitializes the LCD.
  * @param  Instance    LCD Instance
@@ -132,8 +383,140 @@ int32_t LCD_GetPixelFormat(uint32_t Instance, uint32_t *PixelFormat)
   }
   else
   {
-    /* Only RGB565 format is supported */
-    *PixelFormat = LCD_PIXEL_FORMAT_RGB565;
+    *PixelFormat = Lcd_Ctx[Instance].PixelFormat;
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Sets the pixel format on the bus.
+ * @note   Draw buffers stay RGB565. With LCD_PIXEL_FORMAT_RGB444 pixels are
+ *         converted while the FIFO is filled and take 1.5 bytes instead of 2.
+ *         The frame memory keeps its content, so it can change between frames.
+ * @param  Instance    LCD Instance
+ * @param  PixelFormat LCD_PIXEL_FORMAT_RGB565 or LCD_PIXEL_FORMAT_RGB444
+ * @retval Error status
+ */
+int32_t LCD_SetPixelFormat(uint32_t Instance, uint32_t PixelFormat)
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if ((Instance >= LCD_INSTANCES_NBR) ||
+      ((PixelFormat != LCD_PIXEL_FORMAT_RGB565) && (PixelFormat != LCD_PIXEL_FORMAT_RGB444)))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else if (Lcd->SetColorCoding != NULL)
+  {
+    if (Lcd->SetColorCoding(LCD_IO_Select(Instance), (PixelFormat == LCD_PIXEL_FORMAT_RGB444) ? ST7735_FORMAT_RBG444 : ST7735_FORMAT_RBG565) < 0)
+    {
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+    }
+    else
+    {
+      Lcd_Dev[Instance].Pack.Enabled = (PixelFormat == LCD_PIXEL_FORMAT_RGB444);
+      Lcd_Ctx[Instance].PixelFormat = PixelFormat;
+    }
+  }
+  else
+  {
+    ret = BSP_ERROR_FEATURE_NOT_SUPPORTED;
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Sets the lookup table of 8-bit bitmaps.
+ * @note   While a table is set LCD_DrawBitmap() and LCD_DrawBitmapAsync() take
+ *         one byte per pixel, expanded to RGB565 while the FIFO is filled. The
+ *         table is read from the SPI interrupt: keep it in RAM, unchanged while
+ *         a transfer runs.
+ * @param  Instance LCD Instance
+ * @param  pLut     256 RGB565 colors, NULL for RGB565 bitmaps
+ * @retval Error status
+ */
+int32_t LCD_SetLut(uint32_t Instance, const uint16_t *pLut)
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if (Instance >= LCD_INSTANCES_NBR)
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    LCD_IO_WaitIdle();
+    Lcd_Dev[Instance].pLut = pLut;
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Gets the lookup table of 8-bit bitmaps.
+ * @param  Instance LCD Instance
+ * @param  ppLut    table set by LCD_SetLut(), NULL for RGB565 bitmaps
+ * @retval Error status
+ */
+int32_t LCD_GetLut(uint32_t Instance, const uint16_t **ppLut)
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if ((Instance >= LCD_INSTANCES_NBR) || (NULL == ppLut))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    *ppLut = Lcd_Dev[Instance].pLut;
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Fills a lookup table with the RGB332 colors.
+ * @note   Bits 7-5 red, 4-2 green, 1-0 blue, the lv_color8_t layout. Each
+ *         channel is widened by repeating its bits so white stays white.
+ * @param  pLut 256 RGB565 colors
+ * @retval None
+ */
+void LCD_MakeLutRGB332(uint16_t *pLut)
+{
+  uint32_t i, r, g, b;
+
+  for (i = 0; i < 256U; i++)
+  {
+    r = (i >> 5) & 0x07U;
+    g = (i >> 2) & 0x07U;
+    b = i & 0x03U;
+    r = (r << 2) | (r >> 1);
+    g = (g << 3) | g;
+    b = (b << 3) | (b << 1) | (b >> 1);
+    pLut[i] = (uint16_t)((r << 11) | (g << 5) | b);
+  }
+}
+
+/**
+ * @brief  Enables ordered dithering of the RGB444 pixel streams.
+ * @note   Solid fills are never dithered.
+ * @param  Instance LCD Instance
+ * @param  Enable   0 to truncate to 4 bits per channel
+ * @retval Error status
+ */
+int32_t LCD_SetDither(uint32_t Instance, uint32_t Enable)
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if (Instance >= LCD_INSTANCES_NBR)
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    Lcd_Dev[Instance].Pack.Dither = (Enable != 0U);
   }
 
   return ret;
@@ -155,7 +538,7 @@ int32_t LCD_GetXSize(uint32_t Instance, uint32_t *XSize)
   }
   else
   {
-    if (Lcd->GetXSize(Lcd_CompObj, XSize) < 0)
+    if (Lcd->GetXSize(LCD_IO_Select(Instance), XSize) < 0)
     {
       ret = BSP_ERROR_COMPONENT_FAILURE;
     }
@@ -180,7 +563,37 @@ int32_t LCD_GetYSize(uint32_t Instance, uint32_t *YSize)
   }
   else
   {
-    if (Lcd->GetYSize(Lcd_CompObj, YSize) < 0)
+    if (Lcd->GetYSize(LCD_IO_Select(Instance), YSize) < 0)
+    {
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+    }
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Gets the LCD bus statistics.
+ * @param  Instance LCD Instance
+ * @param  Stats    Counters since boot
+ * @retval Error status
+ */
+int32_t LCD_GetStats(uint32_t Instance, LCD_Stats_t *Stats)
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if ((Instance >= LCD_INSTANCES_NBR) || (NULL == Stats))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    Stats->Transactions = Lcd_Dev[Instance].Transactions;
+    if (ST7735_GetWindowStats(&ST7735Obj[Instance], &Stats->Windows, &Stats->WindowTransactions) != ST7735_OK)
+    {
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+    }
+    else if (ST7735_GetGlyphCacheStats(&ST7735Obj[Instance], &Stats->GlyphHits, &Stats->GlyphMisses) != ST7735_OK)
     {
       ret = BSP_ERROR_COMPONENT_FAILURE;
     }
@@ -225,7 +638,7 @@ int32_t LCD_WritePixel(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t
   }
   else if (Lcd->SetPixel != NULL)
   {
-    if (Lcd->SetPixel(Lcd_CompObj, Xpos, Ypos, Color) < 0)
+    if (Lcd->SetPixel(LCD_IO_Select(Instance), Xpos, Ypos, Color) < 0)
     {
       ret = BSP_ERROR_COMPONENT_FAILURE;
     }
@@ -260,7 +673,7 @@ int32_t LCD_DrawChar(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint8_t nu
   }
   else if (Lcd->DrawChar != NULL)
   {
-    if (Lcd->DrawChar(Lcd_CompObj, Xpos, Ypos, num, size, fColor, bColor, mode) < 0)
+    if (Lcd->DrawChar(LCD_IO_Select(Instance), Xpos, Ypos, num, size, fColor, bColor, mode) < 0)
     {
       ret = BSP_ERROR_COMPONENT_FAILURE;
     }
@@ -294,7 +707,7 @@ int32_t LCD_DrawString(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint8_t
   }
   else if (Lcd->DrawChar != NULL)
   {
-    if (Lcd->DrawString(Lcd_CompObj, Xpos, Ypos, string, size, fColor, bColor) < 0)
+    if (Lcd->DrawString(LCD_IO_Select(Instance), Xpos, Ypos, string, size, fColor, bColor) < 0)
     {
       ret = BSP_ERROR_COMPONENT_FAILURE;
     }
@@ -326,7 +739,7 @@ int32_t LCD_DrawHLine(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t
   }
   else if (Lcd->DrawHLine != NULL)
   {
-    if (Lcd->DrawHLine(Lcd_CompObj, Xpos, Ypos, Length, Color) < 0)
+    if (Lcd->DrawHLine(LCD_IO_Select(Instance), Xpos, Ypos, Length, Color) < 0)
     {
       ret = BSP_ERROR_COMPONENT_FAILURE;
     }
@@ -358,7 +771,7 @@ int32_t LCD_DrawVLine(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t
   }
   else if (Lcd->DrawVLine != NULL)
   {
-    if (Lcd->DrawVLine(Lcd_CompObj, Xpos, Ypos, Length, Color) < 0)
+    if (Lcd->DrawVLine(LCD_IO_Select(Instance), Xpos, Ypos, Length, Color) < 0)
     {
       ret = BSP_ERROR_COMPONENT_FAILURE;
     }
@@ -389,7 +802,7 @@ int32_t LCD_DrawBitmap(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t
   }
   else if (Lcd->DrawBitmap != NULL)
   {
-    if (Lcd->DrawBitmap(Lcd_CompObj, Xpos, Ypos, width, height, pBmp) < 0)
+    if (Lcd->DrawBitmap(LCD_IO_Select(Instance), Xpos, Ypos, width, height, pBmp) < 0)
     {
       ret = BSP_ERROR_COMPONENT_FAILURE;
     }
@@ -403,16 +816,17 @@ int32_t LCD_DrawBitmap(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t
 }
 
 /**
- * @brief  Draws a full RGB rectangle
- * @param  Instance LCD Instance.
- * @param  Xpos   specifies the X position.
- * @param  Ypos   specifies the Y position.
- * @param  pData  pointer to RGB data
- * @param  Width  specifies the rectangle width.
- * @param  Height Specifies the rectangle height
- * @retval BSP status
+ * @brief  Draws a bitmap picture (16 bpp) in the background.
+ * @note   Returns as soon as the first FIFO load is on the wire. The remaining
+ *         pixels are streamed from the SPI interrupt and LCD_SignalTransferDone()
+ *         is called once pBmp is no longer needed.
+ * @param  Instance    LCD Instance
+ * @param  Xpos Bmp X position in the LCD
+ * @param  Ypos Bmp Y position in the LCD
+ * @param  pBmp Pointer to Bmp picture address.
+ * @retval Error status
  */
-int32_t LCD_FillRGBRect(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint8_t *pData, uint32_t Width, uint32_t Height)
+int32_t LCD_DrawBitmapAsync(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t width, uint32_t height, uint8_t *pBmp)
 {
   int32_t ret = BSP_ERROR_NONE;
 
@@ -420,10 +834,14 @@ int32_t LCD_FillRGBRect(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint8_t
   {
     ret = BSP_ERROR_WRONG_PARAM;
   }
-  else if (Lcd->FillRGBRect != NULL)
+  else if (Lcd->DrawBitmapAsync != NULL)
   {
-    /* Draw the horizontal line on LCD */
-    if (Lcd->FillRGBRect(Lcd_CompObj, Xpos, Ypos, pData, Width, Height) < 0)
+    /* The previous transfer still reports its own instance, LCD_IO_Select()
+       waits for it when it was the other panel's */
+    LCD_IO_WaitIdle();
+    Lcd_Async.Instance = Instance;
+
+    if (Lcd->DrawBitmapAsync(LCD_IO_Select(Instance), Xpos, Ypos, width, height, pBmp) < 0)
     {
       ret = BSP_ERROR_COMPONENT_FAILURE;
     }
@@ -437,29 +855,39 @@ int32_t LCD_FillRGBRect(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint8_t
 }
 
 /**
- * @brief  Draws a full rectangle.
- * @param  Instance LCD instance
- * @param  Xpos X position
- * @param  Ypos Y position
- * @param  Width Rectangle width
- * @param  Height Rectangle height
- * @param  Color RGB color
+ * @brief  Draws a full RGB rectangle
+ * @note   The pixels are RGB565 in the byte order of LCD_DrawBitmap(), even
+ *         while an 8-bit lookup table is set.
+ * @param  Instance LCD Instance.
+ * @param  Xpos   specifies the X position.
+ * @param  Ypos   specifies the Y position.
+ * @param  pData  pointer to RGB data
+ * @param  Width  specifies the rectangle width.
+ * @param  Height Specifies the rectangle height
  * @retval BSP status
  */
-int32_t LCD_FillRect(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Width, uint32_t Height, uint32_t Color)
+int32_t LCD_FillRGBRect(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint8_t *pData, uint32_t Width, uint32_t Height)
 {
   int32_t ret = BSP_ERROR_NONE;
+  const uint16_t *lut;
 
   if (Instance >= LCD_INSTANCES_NBR)
   {
     ret = BSP_ERROR_WRONG_PARAM;
   }
-  else if (Lcd->FillRect != NULL)
+  else if (Lcd->FillRGBRect != NULL)
   {
-    if (Lcd->FillRect(Lcd_CompObj, Xpos, Ypos, Width, Height, Color) < 0)
+    /* The pixel path reads the table, RGB565 rectangles bypass it */
+    LCD_IO_WaitIdle();
+    lut = Lcd_Dev[Instance].pLut;
+    Lcd_Dev[Instance].pLut = NULL;
+
+    /* Draw the RGB rectangle on LCD */
+    if (Lcd->FillRGBRect(LCD_IO_Select(Instance), Xpos, Ypos, pData, Width, Height) < 0)
     {
       ret = BSP_ERROR_COMPONENT_FAILURE;
     }
+    Lcd_Dev[Instance].pLut = lut;
   }
   else
   {
@@ -470,24 +898,39 @@ int32_t LCD_FillRect(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t W
 }
 
 /**
- * @brief  Enables the display.
- * @param  Instance    LCD Instance
- * @retval Error status
+ * @brief  Draws an RGB rectangle cut out of a larger RGB565 image.
+ * @note   Each row is sent straight from the image through the pixel path, in
+ *         the byte order of LCD_DrawBitmap(), even while an 8-bit lookup table
+ *         is set.
+ * @param  Instance LCD Instance
+ * @param  Xpos     X position
+ * @param  Ypos     Y position
+ * @param  pData    Pointer to the first pixel of the rectangle in the image
+ * @param  Width    Rectangle width
+ * @param  Height   Rectangle height
+ * @param  Stride   Image line length in pixels
+ * @retval BSP status
  */
-int32_t LCD_DisplayOn(uint32_t Instance)
+int32_t LCD_FillRGBRectStride(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint8_t *pData, uint32_t Width, uint32_t Height, uint32_t Stride)
 {
   int32_t ret = BSP_ERROR_NONE;
+  const uint16_t *lut;
 
   if (Instance >= LCD_INSTANCES_NBR)
   {
     ret = BSP_ERROR_WRONG_PARAM;
   }
-  else if (Lcd->DisplayOn != NULL)
+  else if (Lcd->FillRGBRectStride != NULL)
   {
-    if (Lcd->DisplayOn(Lcd_CompObj) < 0)
+    LCD_IO_WaitIdle();
+    lut = Lcd_Dev[Instance].pLut;
+    Lcd_Dev[Instance].pLut = NULL;
+
+    if (Lcd->FillRGBRectStride(LCD_IO_Select(Instance), Xpos, Ypos, pData, Width, Height, Stride) < 0)
     {
       ret = BSP_ERROR_COMPONENT_FAILURE;
     }
+    Lcd_Dev[Instance].pLut = lut;
   }
   else
   {
@@ -498,11 +941,22 @@ int32_t LCD_DisplayOn(uint32_t Instance)
 }
 
 /**
- * @brief  Disables the display.
- * @param  Instance    LCD Instance
- * @retval Error status
+ * @brief  Draws an RGB rectangle cut out of a larger RGB565 image in the
+ *         background.
+ * @note   As LCD_FillRGBRectStride(), but returns once the last row is on the
+ *         wire. LCD_SignalTransferDone() is called when pData is no longer
+ *         needed. Not available while an 8-bit lookup table is set, the
+ *         interrupt would expand the rows through it.
+ * @param  Instance LCD Instance
+ * @param  Xpos     X position
+ * @param  Ypos     Y position
+ * @param  pData    Pointer to the first pixel of the rectangle in the image
+ * @param  Width    Rectangle width
+ * @param  Height   Rectangle height
+ * @param  Stride   Image line length in pixels
+ * @retval BSP status
  */
-int32_t LCD_DisplayOff(uint32_t Instance)
+int32_t LCD_FillRGBRectStrideAsync(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint8_t *pData, uint32_t Width, uint32_t Height, uint32_t Stride)
 {
   int32_t ret = BSP_ERROR_NONE;
 
@@ -510,9 +964,12 @@ int32_t LCD_DisplayOff(uint32_t Instance)
   {
     ret = BSP_ERROR_WRONG_PARAM;
   }
-  else if (Lcd->DisplayOff != NULL)
+  else if ((Lcd->FillRGBRectStrideAsync != NULL) && (NULL == Lcd_Dev[Instance].pLut))
   {
-    if (Lcd->DisplayOff(Lcd_CompObj) < 0)
+    LCD_IO_WaitIdle();
+    Lcd_Async.Instance = Instance;
+
+    if (Lcd->FillRGBRectStrideAsync(LCD_IO_Select(Instance), Xpos, Ypos, pData, Width, Height, Stride) < 0)
     {
       ret = BSP_ERROR_COMPONENT_FAILURE;
     }
@@ -526,12 +983,16 @@ int32_t LCD_DisplayOff(uint32_t Instance)
 }
 
 /**
- * @brief  Set the brightness value
- * @param  Instance    LCD Instance
- * @param  Brightness [00: Min (black), 100 Max]
- * @retval Error status
+ * @brief  Draws a full rectangle.
+ * @param  Instance LCD instance
+ * @param  Xpos X position
+ * @param  Ypos Y position
+ * @param  Width Rectangle width
+ * @param  Height Rectangle height
+ * @param  Color RGB color
+ * @retval BSP status
  */
-int32_t LCD_SetBrightness(uint32_t Instance, uint32_t Brightness)
+int32_t LCD_FillRect(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Width, uint32_t Height, uint32_t Color)
 {
   int32_t ret = BSP_ERROR_NONE;
 
@@ -539,9 +1000,9 @@ int32_t LCD_SetBrightness(uint32_t Instance, uint32_t Brightness)
   {
     ret = BSP_ERROR_WRONG_PARAM;
   }
-  else if (Lcd->SetBrightness != NULL)
+  else if (Lcd->FillRect != NULL)
   {
-    if (Lcd->SetBrightness(Lcd_CompObj, Brightness) < 0)
+    if (Lcd->FillRect(LCD_IO_Select(Instance), Xpos, Ypos, Width, Height, Color) < 0)
     {
       ret = BSP_ERROR_COMPONENT_FAILURE;
     }
@@ -555,12 +1016,16 @@ int32_t LCD_SetBrightness(uint32_t Instance, uint32_t Brightness)
 }
 
 /**
- * @brief  Get the brightness value
- * @param  Instance    LCD Instance
- * @param  Brightness [00: Min (black), 100 Max]
- * @retval Error status
+ * @brief  Draws a rectangle outline, clipped to the display.
+ * @param  Instance LCD Instance
+ * @param  Xpos X position
+ * @param  Ypos Y position
+ * @param  Width Rectangle width
+ * @param  Height Rectangle height
+ * @param  Color Draw color
+ * @retval BSP status
  */
-int32_t LCD_GetBrightness(uint32_t Instance, uint32_t *Brightness)
+int32_t LCD_DrawRect(uint32_t Instance, uint32_t Xpos, uint32_t Ypos, uint32_t Width, uint32_t Height, uint32_t Color)
 {
   int32_t ret = BSP_ERROR_NONE;
 
@@ -568,9 +1033,9 @@ int32_t LCD_GetBrightness(uint32_t Instance, uint32_t *Brightness)
   {
     ret = BSP_ERROR_WRONG_PARAM;
   }
-  else if (Lcd->GetBrightness != NULL)
+  else if (Lcd->DrawRect != NULL)
   {
-    if (Lcd->GetBrightness(Lcd_CompObj, Brightness) < 0)
+    if (Lcd->DrawRect(LCD_IO_Select(Instance), Xpos, Ypos, Width, Height, Color) < 0)
     {
       ret = BSP_ERROR_COMPONENT_FAILURE;
     }
@@ -584,183 +1049,1288 @@ int32_t LCD_GetBrightness(uint32_t Instance, uint32_t *Brightness)
 }
 
 /**
- * @}
+ * @brief  Switches the panel between normal, idle and partial display mode.
+ * @note   Both low power modes keep the frame memory: going back to
+ *         LCD_POWER_MODE_NORMAL shows the full picture again, nothing needs
+ *         redrawing. Partial mode is not available with a scroll area set.
+ * @param  Instance LCD Instance
+ * @param  Mode     LCD_POWER_MODE_NORMAL, LCD_POWER_MODE_IDLE or LCD_POWER_MODE_PARTIAL
+ * @param  Start    first line left on in partial mode
+ * @param  End      last line left on in partial mode
+ * @retval Error status
  */
+int32_t LCD_SetPowerMode(uint32_t Instance, uint32_t Mode, uint32_t Start, uint32_t End)
+{
+  int32_t ret = BSP_ERROR_NONE;
 
-/** @defgroup ADAFRUIT_802_LCD_Private_Functions LCD Private Functions
- * @{
- */
+  if ((Instance >= LCD_INSTANCES_NBR) || (Mode > LCD_POWER_MODE_PARTIAL) ||
+      ((Mode == LCD_POWER_MODE_PARTIAL) &&
+       ((Start > End) || (End >= Lcd_Ctx[Instance].YSize) || (Lcd_Ctx[Instance].ScrollHeight != 0U))))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else if (Lcd->SetPowerMode != NULL)
+  {
+    if (Lcd->SetPowerMode(LCD_IO_Select(Instance), Mode, Start, End) < 0)
+    {
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+    }
+    else
+    {
+      Lcd_Ctx[Instance].PowerMode = Mode;
+    }
+  }
+  else
+  {
+    ret = BSP_ERROR_FEATURE_NOT_SUPPORTED;
+  }
+
+  return ret;
+}
 
 /**
- * @brief  Register Bus IOs if component ID is OK
- * @param  Orientation Display orientation
+ * @brief  Gets the current display mode.
+ * @param  Instance LCD Instance
+ * @param  Mode     LCD_POWER_MODE_NORMAL, LCD_POWER_MODE_IDLE or LCD_POWER_MODE_PARTIAL
  * @retval Error status
  */
-static int32_t ST7735_Probe(uint32_t Orientation)
+int32_t LCD_GetPowerMode(uint32_t Instance, uint32_t *Mode)
 {
   int32_t ret = BSP_ERROR_NONE;
-  ST7735_IO_t IOCtx;
-
-  /* Configure the audio driver */
-  IOCtx.Address = 0;
-  IOCtx.Init = NULL;   // MX_SPI1_Init
-  IOCtx.DeInit = NULL; /*一次初始化后，不需要释放SPI接口*/
-  IOCtx.GetTick = NULL;
-  IOCtx.Delay = (ST7735_Delay_Func)vTaskDelay;
-  IOCtx.WriteReg = LCD_IO_WriteReg;
-  IOCtx.SendData = LCD_IO_SendData;
 
-  if (ST7735_RegisterBusIO(&ST7735Obj, &IOCtx) != ST7735_OK)
+  if ((Instance >= LCD_INSTANCES_NBR) || (NULL == Mode))
   {
-    ret = BSP_ERROR_BUS_FAILURE;
+    ret = BSP_ERROR_WRONG_PARAM;
   }
   else
   {
-    printf("lcd:%p.\n", Lcd);
-    SPI_LCD_REST(GPIO_PIN_SET); /*初始化LCD之前先清除LCD复位信号*/
-                                // HAL_Delay(100);
-    vTaskDelay(100 / portTICK_RATE_MS);
+    *Mode = Lcd_Ctx[Instance].PowerMode;
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Sets the panel refresh rate.
+ * @note   The panel picks the closest rate it can do, see LCD_GetFrameRate().
+ * @param  Instance LCD Instance
+ * @param  Rate     frame rate in Hz
+ * @retval Error status
+ */
+int32_t LCD_SetFrameRate(uint32_t Instance, uint32_t Rate)
+{
+  int32_t ret = BSP_ERROR_NONE;
 
-    if (Lcd->Init && Lcd->Init(Lcd_CompObj, ST7735_FORMAT_DEFAULT, Orientation) != ST7735_OK)
+  if ((Instance >= LCD_INSTANCES_NBR) || (Rate == 0U))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else if (Lcd->SetFrameRate != NULL)
+  {
+    if (Lcd->SetFrameRate(LCD_IO_Select(Instance), Rate) < 0)
     {
       ret = BSP_ERROR_COMPONENT_FAILURE;
     }
   }
+  else
+  {
+    ret = BSP_ERROR_FEATURE_NOT_SUPPORTED;
+  }
+
   return ret;
 }
 
-// typedef enum
-// {
-//   SPI_NULL = 0,
-//   SPI_WRITE,
-//   SPI_READ
-// } spi_master_mode_t;
-// /* SPI transmit data, format: 8bit command (read value: 3, write value: 4) + 8bit address(value: 0x0) + 64byte data
-//  *  For convenience, every time we send 64bytes, SPI SLAVE will determine how much data to read based on the status value
-//  */
-// static esp_err_t IRAM_ATTR spi_master_transmit(spi_master_mode_t trans_mode, uint32_t *data)
-// {
-//   spi_trans_t trans;
-//   uint16_t cmd;
-//   // uint32_t addr = 0x0;
+/**
+ * @brief  Gets the panel refresh rate.
+ * @param  Instance LCD Instance
+ * @param  Rate     frame rate in Hz
+ * @retval Error status
+ */
+int32_t LCD_GetFrameRate(uint32_t Instance, uint32_t *Rate)
+{
+  int32_t ret = BSP_ERROR_NONE;
 
-//   memset(&trans, 0x0, sizeof(trans));
-//   trans.bits.val = 0; // clear all bit
+  if ((Instance >= LCD_INSTANCES_NBR) || (NULL == Rate))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else if (Lcd->GetFrameRate != NULL)
+  {
+    if (Lcd->GetFrameRate(LCD_IO_Select(Instance), Rate) < 0)
+    {
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+    }
+  }
+  else
+  {
+    ret = BSP_ERROR_FEATURE_NOT_SUPPORTED;
+  }
 
-//   if (trans_mode == SPI_WRITE)
-//   {
-//     cmd = SPI_MASTER_WRITE_DATA_TO_SLAVE_CMD;
-//     trans.bits.mosi = 8 * 64; // One time transmit only support 64bytes
-//     trans.mosi = data;
-//   }
-//   else if (trans_mode == SPI_READ)
-//   {
-//     cmd = SPI_MASTER_READ_DATA_FROM_SLAVE_CMD;
-//     trans.bits.miso = 8 * 64;
-//     trans.miso = data;
-//   }
+  return ret;
+}
 
-//   trans.bits.cmd = 8 * 1;
-//   // trans.bits.addr = 8 * 1; // transmit data will use 8bit address
-//   trans.cmd = &cmd;
-//   // trans.addr = &addr;
+/**
+ * @brief  Defines the hardware scroll area and resets its offset.
+ * @param  Instance LCD Instance
+ * @param  Top      lines fixed at the top, e.g. a title bar
+ * @param  Bottom   lines fixed at the bottom, e.g. a status bar
+ * @retval Error status
+ */
+int32_t LCD_ScrollSetArea(uint32_t Instance, uint32_t Top, uint32_t Bottom)
+{
+  int32_t ret = BSP_ERROR_NONE;
 
-//   return spi_trans(HSPI_HOST, &trans);
-// }
+  if ((Instance >= LCD_INSTANCES_NBR) || ((Top + Bottom) >= Lcd_Ctx[Instance].YSize))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else if ((Lcd->SetScrollArea != NULL) && (Lcd->SetScrollOffset != NULL))
+  {
+    Lcd_Ctx[Instance].ScrollHeight = 0U;
+    if ((Lcd->SetScrollArea(LCD_IO_Select(Instance), Top, Bottom) < 0) ||
+        (Lcd->SetScrollOffset(LCD_IO_Select(Instance), 0U) < 0))
+    {
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+    }
+    else
+    {
+      Lcd_Ctx[Instance].ScrollTop = Top;
+      Lcd_Ctx[Instance].ScrollHeight = Lcd_Ctx[Instance].YSize - Top - Bottom;
+      Lcd_Ctx[Instance].ScrollOffset = 0U;
+    }
+  }
+  else
+  {
+    ret = BSP_ERROR_FEATURE_NOT_SUPPORTED;
+  }
+
+  return ret;
+}
 
-// Write an 8-bit cmd
-static esp_err_t spi_master_transmit(uint8_t data)
+/**
+ * @brief  Sets the hardware scroll offset.
+ * @param  Instance LCD Instance
+ * @param  Offset   lines the scroll area content is moved up by, modulo its height
+ * @retval Error status
+ */
+int32_t LCD_ScrollSetOffset(uint32_t Instance, uint32_t Offset)
 {
-  /*In order to improve the transmission efficiency,
-  it is recommended that the external incoming data is (uint32_t *) type data,
-  do not use other type data.*/
-  uint32_t buf = data; //  << 24
-  spi_trans_t trans = {0};
-  trans.mosi = &buf;
-  trans.bits.mosi = 8;
+  int32_t ret = BSP_ERROR_NONE;
+
+  if ((Instance >= LCD_INSTANCES_NBR) || (Lcd_Ctx[Instance].ScrollHeight == 0U))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    Offset %= Lcd_Ctx[Instance].ScrollHeight;
+    if (Lcd->SetScrollOffset(LCD_IO_Select(Instance), Offset) < 0)
+    {
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+    }
+    else
+    {
+      Lcd_Ctx[Instance].ScrollOffset = Offset;
+    }
+  }
 
-  spi_trans(HSPI_HOST, &trans);
-  return ESP_OK;
+  return ret;
 }
 
 /**
- * @brief  Writes command to select the LCD register.
- * @param  Reg Address of the selected register.
- * @param  pData pointer to data to write to the register
- * @param  Length length of data to write to the register
+ * @brief  Scrolls the scroll area up and clears the lines exposed at its bottom.
+ * @note   The exposed lines are the ones that left the top: they are cleared
+ *         first, so the old content never wraps around to the bottom. Use
+ *         LCD_ScrollGetLine() to draw into them afterwards.
+ * @param  Instance LCD Instance
+ * @param  Lines    lines to scroll by, at most the scroll area height
+ * @param  Color    RGB color of the exposed lines
  * @retval Error status
  */
-static int32_t LCD_IO_WriteReg(uint8_t Reg, uint8_t *pData, uint32_t Length)
+int32_t LCD_ScrollLines(uint32_t Instance, uint32_t Lines, uint32_t Color)
 {
   int32_t ret = BSP_ERROR_NONE;
+  uint32_t first, count;
 
-  // if ((NULL == pData) || !Length)
-  //   return BSP_ERROR_PERIPH_FAILURE;
+  if ((Instance >= LCD_INSTANCES_NBR) || (Lcd_Ctx[Instance].ScrollHeight == 0U) ||
+      (Lines > Lcd_Ctx[Instance].ScrollHeight))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    /* The lines leaving the top are drawing lines ScrollOffset .. ScrollOffset + Lines - 1
+       of the area, in at most two windows when they wrap around its end */
+    first = Lcd_Ctx[Instance].ScrollOffset;
+    count = Lcd_Ctx[Instance].ScrollHeight - first;
+    if (count > Lines)
+    {
+      count = Lines;
+    }
+    ret = LCD_FillRect(Instance, 0U, Lcd_Ctx[Instance].ScrollTop + first, Lcd_Ctx[Instance].XSize, count, Color);
+    if ((ret == BSP_ERROR_NONE) && (count < Lines))
+    {
+      ret = LCD_FillRect(Instance, 0U, Lcd_Ctx[Instance].ScrollTop, Lcd_Ctx[Instance].XSize, Lines - count, Color);
+    }
+    if (ret == BSP_ERROR_NONE)
+    {
+      ret = LCD_ScrollSetOffset(Instance, first + Lines);
+    }
+  }
 
-  /* Reset LCD control line CS */
-  // SPI_LCD_CS(GPIO_PIN_RESET);
-  /* Set LCD data/command line DC to Low */
-  SPI_LCD_DC(GPIO_PIN_RESET);
+  return ret;
+}
 
-  // while (Length--)
+/**
+ * @brief  Gets the drawing Y position of a display line.
+ * @note   Fixed lines map to themselves, scroll area lines follow the offset.
+ * @param  Instance LCD Instance
+ * @param  Line     line as seen on the display
+ * @param  Ypos     Y position to draw it at
+ * @retval Error status
+ */
+int32_t LCD_ScrollGetLine(uint32_t Instance, uint32_t Line, uint32_t *Ypos)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  LCD_Ctx_t *ctx;
+
+  if ((Instance >= LCD_INSTANCES_NBR) || (NULL == Ypos))
   {
-    /* Send Command */
-    ret = spi_master_transmit(Reg); //++
-    // SPI_LCD_CS(GPIO_PIN_SET);
-    /* Send Data */
-    ret = LCD_IO_SendData(pData, Length);
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    ctx = &Lcd_Ctx[Instance];
+    *Ypos = Line;
+    if ((Line >= ctx->ScrollTop) && (Line < (ctx->ScrollTop + ctx->ScrollHeight)))
+    {
+      *Ypos = ctx->ScrollTop + ((Line - ctx->ScrollTop + ctx->ScrollOffset) % ctx->ScrollHeight);
+    }
   }
-
-  // if (spi_master_transmit(*pData))
-  // {
-  //   ret = BSP_ERROR_PERIPH_FAILURE;
-  // }
-  // else
-  // {
-  //   /* Deselect : Chip Select high */
-  //   // SPI_LCD_CS(GPIO_PIN_SET);
-  //   /* Send Data */
-  //   ret = LCD_IO_SendData(pData, Length);
-  // }
 
   return ret;
 }
 
 /**
- * @brief  Send data to select the LCD GRAM.
- * @param  pData pointer to data to write to LCD GRAM.
- * @param  Length length of data to write to LCD GRAM
+ * @brief  Enables the display.
+ * @param  Instance    LCD Instance
  * @retval Error status
  */
-static int32_t LCD_IO_SendData(uint8_t *pData, uint32_t Length)
+int32_t LCD_DisplayOn(uint32_t Instance)
 {
   int32_t ret = BSP_ERROR_NONE;
 
-  if ((NULL == pData) || !Length)
-    return ret; // BSP_ERROR_PERIPH_FAILURE
+  if (Instance >= LCD_INSTANCES_NBR)
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else if (Lcd->DisplayOn != NULL)
+  {
+    if (Lcd->DisplayOn(LCD_IO_Select(Instance)) < 0)
+    {
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+    }
+  }
+  else
+  {
+    ret = BSP_ERROR_FEATURE_NOT_SUPPORTED;
+  }
 
-  /* Reset LCD control line CS */
-  // SPI_LCD_CS(GPIO_PIN_RESET);
-  /* Set LCD data/command line DC to High */
-  SPI_LCD_DC(GPIO_PIN_SET);
+  return ret;
+}
+
+/**
+ * @brief  Disables the display.
+ * @param  Instance    LCD Instance
+ * @retval Error status
+ */
+int32_t LCD_DisplayOff(uint32_t Instance)
+{
+  int32_t ret = BSP_ERROR_NONE;
 
-  // for (uint32_t i = 0; i < Length; i++)
-  while (Length--)
+  if (Instance >= LCD_INSTANCES_NBR)
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else if (Lcd->DisplayOff != NULL)
   {
-    if (spi_master_transmit(*pData++)) //
+    if (Lcd->DisplayOff(LCD_IO_Select(Instance)) < 0)
     {
-      ret = BSP_ERROR_PERIPH_FAILURE;
-      break;
+      ret = BSP_ERROR_COMPONENT_FAILURE;
     }
-    // printf("data[%d]: %#x.\r\n", Length, *pData);
   }
-
-  /* Deselect : Chip Select high */
-  // SPI_LCD_CS(GPIO_PIN_SET);
+  else
+  {
+    ret = BSP_ERROR_FEATURE_NOT_SUPPORTED;
+  }
 
   return ret;
 }
 
+/**
+ * @brief  Set the brightness value
+ * @param  Instance    LCD Instance
+ * @param  Brightness [00: Min (black), 100 Max]
+ * @retval Error status
+ */
+int32_t LCD_SetBrightness(uint32_t Instance, uint32_t Brightness)
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if (Instance >= LCD_INSTANCES_NBR)
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else if (Lcd->SetBrightness != NULL)
+  {
+    if (Lcd->SetBrightness(LCD_IO_Select(Instance), Brightness) < 0)
+    {
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+    }
+  }
+  else
+  {
+    ret = BSP_ERROR_FEATURE_NOT_SUPPORTED;
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Get the brightness value
+ * @param  Instance    LCD Instance
+ * @param  Brightness [00: Min (black), 100 Max]
+ * @retval Error status
+ */
+int32_t LCD_GetBrightness(uint32_t Instance, uint32_t *Brightness)
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if (Instance >= LCD_INSTANCES_NBR)
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else if (Lcd->GetBrightness != NULL)
+  {
+    if (Lcd->GetBrightness(LCD_IO_Select(Instance), Brightness) < 0)
+    {
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+    }
+  }
+  else
+  {
+    ret = BSP_ERROR_FEATURE_NOT_SUPPORTED;
+  }
+
+  return ret;
+}
+
+/**
+ * @}
+ */
+
+/** @defgroup ADAFRUIT_802_LCD_Private_Functions LCD Private Functions
+ * @{
+ */
+
+/**
+ * @brief  Register Bus IOs if component ID is OK
+ * @param  Instance    LCD Instance
+ * @param  Orientation Display orientation
+ * @retval Error status
+ */
+static int32_t ST7735_Probe(uint32_t Instance, uint32_t Orientation)
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if (LCD_IO_Attach(Instance) != BSP_ERROR_NONE)
+  {
+    ret = BSP_ERROR_BUS_FAILURE;
+  }
+  else
+  {
+    printf("lcd:%p.\n", Lcd);
+    SPI_LCD_REST(GPIO_PIN_SET); /*初始化LCD之前先清除LCD复位信号*/
+                                // HAL_Delay(100);
+    vTaskDelay(100 / portTICK_RATE_MS);
+
+    if (Lcd->Init && Lcd->Init(LCD_IO_Select(Instance), ST7735_FORMAT_DEFAULT, Orientation) != ST7735_OK)
+    {
+      ret = BSP_ERROR_COMPONENT_FAILURE;
+    }
+  }
+  return ret;
+}
+
+/**
+ * @brief  Register the panel on the bus and its IO functions with the driver.
+ * @param  Instance LCD Instance
+ * @retval Error status
+ */
+static int32_t LCD_IO_Attach(uint32_t Instance)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  ST7735_IO_t IOCtx;
+  SPI_BUS_DevConfig_t BusCfg;
+
+  /* Configure the audio driver */
+  IOCtx.Address = 0;
+  IOCtx.Init = NULL;   // MX_SPI1_Init
+  IOCtx.DeInit = NULL; /*一次初始化后，不需要释放SPI接口*/
+  IOCtx.GetTick = NULL;
+  IOCtx.Delay = LCD_IO_Delay;
+  IOCtx.WriteReg = LCD_IO_BusWriteReg;
+  IOCtx.SendData = LCD_IO_BusSendData;
+  IOCtx.SendPixels = LCD_IO_BusSendPixels;
+  IOCtx.SendPixelsAsync = LCD_IO_BusSendPixelsAsync;
+  IOCtx.FillPixels = LCD_IO_BusFillPixels;
+
+  BusCfg.Name = Instance ? "lcd1" : "lcd0";
+  BusCfg.ClkDiv = LCD_SPI_CLK_DIV;
+  BusCfg.Mode = LCD_SPI_MODE;
+  BusCfg.CsPin = SPI_BUS_SOFT_CS ? Lcd_Dev[Instance].CsPin : SPI_BUS_CS_NONE;
+  BusCfg.Priority = SPI_BUS_PRIO_LOW;
+
+  if (!Lcd_Dev[Instance].OnBus && (SPI_BUS_AddDevice(&BusCfg, &Lcd_Dev[Instance].BusDev) == BSP_ERROR_NONE))
+  {
+    Lcd_Dev[Instance].OnBus = 1U;
+  }
+
+  if (!Lcd_Dev[Instance].OnBus || (ST7735_RegisterBusIO(&ST7735Obj[Instance], &IOCtx) != ST7735_OK))
+  {
+    ret = BSP_ERROR_BUS_FAILURE;
+  }
+  return ret;
+}
+
+/**
+ * @brief  Checksum of a saved panel state, RTC memory holds garbage after power-up.
+ * @param  pState saved state
+ * @retval Checksum of the words before Checksum
+ */
+static uint32_t LCD_ResumeChecksum(const LCD_Resume_t *pState)
+{
+  const uint32_t *p = (const uint32_t *)pState;
+  uint32_t sum = 0x5A5A5A5AU;
+  uint32_t i;
+
+  for (i = 0; i < (offsetof(LCD_Resume_t, Checksum) / sizeof(uint32_t)); i++)
+  {
+    sum = ((sum << 5) | (sum >> 27)) ^ p[i];
+  }
+
+  return sum;
+}
+
+// typedef enum
+// {
+//   SPI_NULL = 0,
+//   SPI_WRITE,
+//   SPI_READ
+// } spi_master_mode_t;
+// /* SPI transmit data, format: 8bit command (read value: 3, write value: 4) + 8bit address(value: 0x0) + 64byte data
+//  *  For convenience, every time we send 64bytes, SPI SLAVE will determine how much data to read based on the status value
+//  */
+// static esp_err_t IRAM_ATTR spi_master_transmit(spi_master_mode_t trans_mode, uint32_t *data)
+// {
+//   spi_trans_t trans;
+//   uint16_t cmd;
+//   // uint32_t addr = 0x0;
+
+//   memset(&trans, 0x0, sizeof(trans));
+//   trans.bits.val = 0; // clear all bit
+
+//   if (trans_mode == SPI_WRITE)
+//   {
+//     cmd = SPI_MASTER_WRITE_DATA_TO_SLAVE_CMD;
+//     trans.bits.mosi = 8 * 64; // One time transmit only support 64bytes
+//     trans.mosi = data;
+//   }
+//   else if (trans_mode == SPI_READ)
+//   {
+//     cmd = SPI_MASTER_READ_DATA_FROM_SLAVE_CMD;
+//     trans.bits.miso = 8 * 64;
+//     trans.miso = data;
+//   }
+
+//   trans.bits.cmd = 8 * 1;
+//   // trans.bits.addr = 8 * 1; // transmit data will use 8bit address
+//   trans.cmd = &cmd;
+//   // trans.addr = &addr;
+
+//   return spi_trans(HSPI_HOST, &trans);
+// }
+
+/**
+ * @brief  LCD delay
+ * @param  Delay Delay in ms, rounded up to whole ticks
+ * @retval None
+ */
+static void LCD_IO_Delay(uint32_t Delay)
+{
+  vTaskDelay((Delay + portTICK_RATE_MS - 1U) / portTICK_RATE_MS);
+}
+
+/**
+ * @brief  Wait until the HSPI master has shifted out the last transaction.
+ * @note   Transactions are started without waiting for them to finish, so the
+ *         D/C line must not be switched while a burst is still on the wire.
+ *         A background pixel transfer is waited for as well.
+ * @retval None
+ */
+static inline void LCD_IO_WaitIdle(void)
+{
+  while (Lcd_Async.Busy || SPI1.cmd.usr)
+    ;
+}
+
+/**
+ * @brief  Start a write-only transaction of the bytes loaded into the FIFO.
+ * @param  Length length in bytes, not above LCD_SPI_FIFO_SIZE.
+ * @retval None
+ */
+static inline void IRAM_ATTR LCD_IO_Start(uint32_t Length)
+{
+  SPI1.user.usr_command = 0;
+  SPI1.user.usr_addr = 0;
+  SPI1.user.usr_dummy = 0;
+  SPI1.user.usr_miso = 0;
+  SPI1.user.usr_mosi = 1;
+  SPI1.user1.usr_mosi_bitlen = Length * 8U - 1U;
+  SPI1.cmd.usr = 1;
+  Lcd_Io->Transactions++;
+  SPI_BUS_Account(Length);
+}
+
+/**
+ * @brief  Drive the LCD data/command line, skipped when it already has the level.
+ * @note   The bus must be idle. The pin is set through the GPIO W1TS/W1TC
+ *         registers instead of gpio_set_level().
+ * @param  Level GPIO_PIN_SET for data, GPIO_PIN_RESET for command.
+ * @retval None
+ */
+static inline void IRAM_ATTR LCD_IO_SetDC(uint8_t Level)
+{
+  if (Lcd_DcLevel != Level)
+  {
+    if (Level)
+      GPIO.out_w1ts = 1U << Lcd_Io->DcPin;
+    else
+      GPIO.out_w1tc = 1U << Lcd_Io->DcPin;
+    Lcd_DcLevel = Level;
+  }
+}
+
+/**
+ * @brief  Burst data through the HSPI FIFO.
+ * @note   Data is packed into 32-bit words by LCD_FIFO_Pack() and up to
+ *         LCD_SPI_FIFO_SIZE bytes are written straight into the FIFO registers
+ *         per transaction, bypassing spi_trans(). The stream on the wire is the
+ *         same as one transaction per byte, tools/test_lcd_fifo.c checks it.
+ * @param  pData pointer to data to send.
+ * @param  Length length of data to send.
+ * @retval Error status
+ */
+static int32_t IRAM_ATTR LCD_IO_Transmit(const uint8_t *pData, uint32_t Length)
+{
+  uint32_t buf[LCD_SPI_FIFO_SIZE / sizeof(uint32_t)];
+  uint32_t chunk, i;
+
+  while (Length)
+  {
+    chunk = LCD_FIFO_Pack(buf, pData, Length);
+    while (SPI1.cmd.usr)
+      ;
+    for (i = 0; i < (chunk + 3U) / 4U; i++)
+    {
+      SPI1.data_buf[i] = buf[i];
+    }
+    LCD_IO_Start(chunk);
+    pData += chunk;
+    Length -= chunk;
+  }
+
+  return BSP_ERROR_NONE;
+}
+
+/**
+ * @brief  Writes command to select the LCD register.
+ * @param  Reg Address of the selected register.
+ * @param  pData pointer to data to write to the register
+ * @param  Length length of data to write to the register
+ * @retval Error status
+ */
+static int32_t LCD_IO_WriteReg(uint8_t Reg, uint8_t *pData, uint32_t Length)
+{
+  int32_t ret;
+
+  /* Set LCD data/command line DC to Low */
+  LCD_IO_WaitIdle();
+  LCD_IO_FlushCarry();
+  LCD_IO_SetDC(GPIO_PIN_RESET);
+
+  /* Follow the address window, RAMWR starts a pixel stream at its top left */
+  if ((Reg == ST7735_CASET) && (Length == 4U))
+  {
+    Lcd_Io->Pack.XStart = (uint16_t)((pData[0] << 8) | pData[1]);
+    Lcd_Io->Pack.XEnd = (uint16_t)((pData[2] << 8) | pData[3]);
+  }
+  else if ((Reg == ST7735_RASET) && (Length == 4U))
+  {
+    Lcd_Io->Pack.YStart = (uint16_t)((pData[0] << 8) | pData[1]);
+  }
+  Lcd_Io->Pack.Stream = (Reg == ST7735_WRITE_RAM);
+  Lcd_Io->Pack.X = Lcd_Io->Pack.XStart;
+  Lcd_Io->Pack.Y = Lcd_Io->Pack.YStart;
+
+  /* Send Command */
+  ret = LCD_IO_Transmit(&Reg, 1U);
+  if (ret == BSP_ERROR_NONE)
+  {
+    /* Send Data */
+    ret = LCD_IO_SendData(pData, Length);
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Send data to select the LCD GRAM.
+ * @param  pData pointer to data to write to LCD GRAM.
+ * @param  Length length of data to write to LCD GRAM
+ * @retval Error status
+ */
+static int32_t LCD_IO_SendData(uint8_t *pData, uint32_t Length)
+{
+  if ((NULL == pData) || !Length)
+    return BSP_ERROR_NONE;
+
+  /* Pixels staged by the driver are in panel byte order */
+  if (Lcd_Io->Pack.Enabled && Lcd_Io->Pack.Stream)
+    return LCD_IO_SendPixels444((const uint8_t **)&pData, Length, 1U);
+
+  /* Set LCD data/command line DC to High */
+  LCD_IO_WaitIdle();
+  LCD_IO_SetDC(GPIO_PIN_SET);
+
+  return LCD_IO_Transmit(pData, Length);
+}
+
+/**
+ * @brief  Load up to one FIFO of RGB565 pixels and start the transaction.
+ * @note   Called with the bus idle, from task context or from the SPI interrupt.
+ *         LVGL keeps lv_color_t little-endian while the panel expects the high
+ *         byte first, so unless LCD_IO_SWAP_PIXELS is 0 the bytes of each pixel
+ *         are exchanged two pixels (one FIFO word) at a time. Pixels are read as
+ *         halfwords because draw buffers are only 2-byte aligned.
+ * @param  pData pointer to the pixels.
+ * @param  Length length in bytes, even and not above LCD_SPI_FIFO_SIZE.
+ * @retval None
+ */
+static void IRAM_ATTR LCD_IO_LoadPixels(const uint8_t *pData, uint32_t Length)
+{
+  const uint16_t *pix = (const uint16_t *)pData;
+  uint32_t words = Length / 4U;
+  uint32_t word, i;
+
+  for (i = 0; i < words; i++)
+  {
+    word = (uint32_t)pix[0] | ((uint32_t)pix[1] << 16);
+#if LCD_IO_SWAP_PIXELS
+    word = ((word & 0x00FF00FFU) << 8) | ((word >> 8) & 0x00FF00FFU);
+#endif
+    SPI1.data_buf[i] = word;
+    pix += 2;
+  }
+  if (Length & 2U)
+  {
+#if LCD_IO_SWAP_PIXELS
+    SPI1.data_buf[i] = (uint32_t)((pix[0] << 8) | (pix[0] >> 8)) & 0xFFFFU;
+#else
+    SPI1.data_buf[i] = pix[0];
+#endif
+  }
+
+  LCD_IO_Start(Length);
+}
+
+/**
+ * @brief  Load up to one FIFO of 8-bit pixels expanded through the LUT and
+ *         start the transaction.
+ * @note   Called with the bus idle, from task context or from the SPI interrupt.
+ *         Two table lookups make one FIFO word, swapped to panel byte order
+ *         like LCD_IO_LoadPixels().
+ * @param  pData pointer to the 8-bit pixels.
+ * @param  Length length on the bus in bytes, twice the pixels, even and not
+ *         above LCD_SPI_FIFO_SIZE.
+ * @retval None
+ */
+static void IRAM_ATTR LCD_IO_LoadPixels8(const uint8_t *pData, uint32_t Length)
+{
+  const uint16_t *lut = Lcd_Io->pLut;
+  uint32_t words = Length / 4U;
+  uint32_t word, i;
+
+  for (i = 0; i < words; i++)
+  {
+    word = (uint32_t)lut[pData[0]] | ((uint32_t)lut[pData[1]] << 16);
+    SPI1.data_buf[i] = ((word & 0x00FF00FFU) << 8) | ((word >> 8) & 0x00FF00FFU);
+    pData += 2;
+  }
+  if (Length & 2U)
+  {
+    word = lut[pData[0]];
+    SPI1.data_buf[i] = ((word << 8) | (word >> 8)) & 0xFFFFU;
+  }
+
+  LCD_IO_Start(Length);
+}
+
+/**
+ * @brief  Send RGB565 pixels to the LCD GRAM in panel byte order.
+ * @note   The FIFO is packed straight from pData, LCD_SPI_FIFO_SIZE bytes per
+ *         transaction, with no intermediate copy.
+ * @param  pData pointer to the pixels.
+ * @param  Length length of data to write in bytes.
+ * @retval Error status
+ */
+static int32_t IRAM_ATTR LCD_IO_SendPixels(uint8_t *pData, uint32_t Length)
+{
+  uint32_t chunk;
+
+  if ((NULL == pData) || (Length & 1U))
+    return BSP_ERROR_WRONG_PARAM;
+
+  if (Lcd_Io->Pack.Enabled)
+    return LCD_IO_SendPixels444((const uint8_t **)&pData, Length, 0U);
+
+  /* Set LCD data/command line DC to High */
+  LCD_IO_WaitIdle();
+  LCD_IO_SetDC(GPIO_PIN_SET);
+
+  while (Length)
+  {
+    chunk = (Length > LCD_SPI_FIFO_SIZE) ? LCD_SPI_FIFO_SIZE : Length;
+    while (SPI1.cmd.usr)
+      ;
+    if (Lcd_Io->pLut != NULL)
+    {
+      LCD_IO_LoadPixels8(pData, chunk);
+      pData += chunk / 2U;
+    }
+    else
+    {
+      LCD_IO_LoadPixels(pData, chunk);
+      pData += chunk;
+    }
+    Length -= chunk;
+  }
+
+  return BSP_ERROR_NONE;
+}
+
+/**
+ * @brief  Send one RGB565 pixel repeatedly to the LCD GRAM.
+ * @note   The FIFO is filled with the pixel once per transaction from a
+ *         precomputed word, so a solid fill costs a few register writes per
+ *         32 pixels and needs no pattern buffer in RAM.
+ * @param  pData pointer to the pixel, 2 bytes in panel byte order.
+ * @param  Length length of data to write in bytes.
+ * @retval Error status
+ */
+static int32_t IRAM_ATTR LCD_IO_FillPixels(uint8_t *pData, uint32_t Length)
+{
+  uint32_t word, chunk, i;
+
+  if ((NULL == pData) || (Length & 1U))
+    return BSP_ERROR_WRONG_PARAM;
+
+  if (Lcd_Io->Pack.Enabled)
+    return LCD_IO_FillPixels444(pData, Length);
+
+  /* Set LCD data/command line DC to High */
+  LCD_IO_WaitIdle();
+  LCD_IO_SetDC(GPIO_PIN_SET);
+
+  /* BYTE_TX_ORDER = 0: the low byte of the word goes out first */
+  word = (uint32_t)pData[0] | ((uint32_t)pData[1] << 8);
+  word |= word << 16;
+  while (Length)
+  {
+    chunk = (Length > LCD_SPI_FIFO_SIZE) ? LCD_SPI_FIFO_SIZE : Length;
+    while (SPI1.cmd.usr)
+      ;
+    for (i = 0; i < (chunk + 3U) / 4U; i++)
+    {
+      SPI1.data_buf[i] = word;
+    }
+    LCD_IO_Start(chunk);
+    Length -= chunk;
+  }
+
+  return BSP_ERROR_NONE;
+}
+
+/**
+ * @brief  Convert an RGB565 pixel to RGB444 by truncation.
+ * @param  Pixel RGB565
+ * @retval RGB444 in the low 12 bits
+ */
+static inline uint32_t IRAM_ATTR LCD_IO_To444(uint32_t Pixel)
+{
+  return ((Pixel >> 4) & 0xF00U) | ((Pixel >> 3) & 0x0F0U) | ((Pixel >> 1) & 0x00FU);
+}
+
+/**
+ * @brief  Convert an RGB565 pixel to RGB444 with ordered dithering.
+ * @note   The Bayer threshold, scaled to the bits each channel loses, is added
+ *         before truncation. The position advances through the address window.
+ * @param  Pixel RGB565
+ * @retval RGB444 in the low 12 bits
+ */
+static inline uint32_t IRAM_ATTR LCD_IO_Dither444(uint32_t Pixel)
+{
+  uint32_t t = Lcd_Bayer[((Lcd_Io->Pack.Y & 3U) << 2) | (Lcd_Io->Pack.X & 3U)];
+  uint32_t r = (Pixel >> 11) + (t >> 3);
+  uint32_t g = ((Pixel >> 5) & 0x3FU) + (t >> 2);
+  uint32_t b = (Pixel & 0x1FU) + (t >> 3);
+
+  if (++Lcd_Io->Pack.X > Lcd_Io->Pack.XEnd)
+  {
+    Lcd_Io->Pack.X = Lcd_Io->Pack.XStart;
+    Lcd_Io->Pack.Y++;
+  }
+  r = (r > 0x1FU) ? 0x1FU : r;
+  g = (g > 0x3FU) ? 0x3FU : g;
+  b = (b > 0x1FU) ? 0x1FU : b;
+
+  return ((r >> 1) << 8) | ((g >> 2) << 4) | (b >> 1);
+}
+
+/**
+ * @brief  Load up to LCD_IO_PACK_PIXELS pixels as RGB444 and start the transaction.
+ * @note   Two pixels go out as three bytes, RRRRGGGG BBBBRRRR GGGGBBBB. The
+ *         kernel packs 8 little-endian pixels into 3 FIFO words at a time; a
+ *         pair split by the caller, dithering and driver data in panel byte
+ *         order take the byte path. An unpaired last pixel is kept in Carry
+ *         for the next call, LCD_IO_FlushCarry() sends it before a command.
+ *         Called with the bus idle, from task context or from the SPI interrupt.
+ *         8-bit bitmaps are expanded through the LUT on the byte path.
+ * @param  ppData    pointer to the pixels, advanced past the ones loaded.
+ * @param  Length    length in RGB565 bytes, even.
+ * @param  BigEndian pixels are high byte first, never indexed
+ * @retval RGB565 bytes consumed from Length
+ */
+static uint32_t IRAM_ATTR LCD_IO_LoadPixels444(const uint8_t **ppData, uint32_t Length, uint8_t BigEndian)
+{
+  uint32_t buf[LCD_SPI_FIFO_SIZE / sizeof(uint32_t)];
+  const uint16_t *lut = BigEndian ? NULL : Lcd_Io->pLut;
+  const uint8_t *pData = *ppData;
+  const uint16_t *pix = (const uint16_t *)pData;
+  uint32_t p01, p23, p45, p67, v, c;
+  uint32_t words = 0, pixels, n, i;
+  uint8_t *out = (uint8_t *)buf;
+
+  n = Length / 2U;
+  if (n > (LCD_IO_PACK_PIXELS - Lcd_Io->Pack.Pending))
+  {
+    n = LCD_IO_PACK_PIXELS - Lcd_Io->Pack.Pending;
+  }
+  pixels = n;
+
+  if (!Lcd_Io->Pack.Pending && !Lcd_Io->Pack.Dither && !BigEndian && (NULL == lut))
+  {
+    /* BYTE_TX_ORDER = 0 sends the low byte of a word first: swap the big-endian words */
+    for (; n >= 8U; n -= 8U)
+    {
+      p01 = (LCD_IO_To444(pix[0]) << 12) | LCD_IO_To444(pix[1]);
+      p23 = (LCD_IO_To444(pix[2]) << 12) | LCD_IO_To444(pix[3]);
+      p45 = (LCD_IO_To444(pix[4]) << 12) | LCD_IO_To444(pix[5]);
+      p67 = (LCD_IO_To444(pix[6]) << 12) | LCD_IO_To444(pix[7]);
+      SPI1.data_buf[words++] = __builtin_bswap32((p01 << 8) | (p23 >> 16));
+      SPI1.data_buf[words++] = __builtin_bswap32((p23 << 16) | (p45 >> 8));
+      SPI1.data_buf[words++] = __builtin_bswap32((p45 << 24) | p67);
+      pix += 8;
+    }
+  }
+
+  pData = (const uint8_t *)pix;
+  for (; n; n--)
+  {
+    if (lut != NULL)
+    {
+      v = lut[*pData++];
+    }
+    else
+    {
+      v = BigEndian ? ((pData[0] << 8) | pData[1]) : (pData[0] | (pData[1] << 8));
+      pData += 2;
+    }
+    c = Lcd_Io->Pack.Dither ? LCD_IO_Dither444(v) : LCD_IO_To444(v);
+    if (Lcd_Io->Pack.Pending)
+    {
+      *out++ = (uint8_t)(Lcd_Io->Pack.Carry >> 4);
+      *out++ = (uint8_t)((Lcd_Io->Pack.Carry << 4) | (c >> 8));
+      *out++ = (uint8_t)c;
+      Lcd_Io->Pack.Pending = 0U;
+    }
+    else
+    {
+      Lcd_Io->Pack.Carry = (uint16_t)c;
+      Lcd_Io->Pack.Pending = 1U;
+    }
+  }
+
+  n = (uint32_t)(out - (uint8_t *)buf);
+  for (i = 0; i < (n + 3U) / 4U; i++)
+  {
+    SPI1.data_buf[words + i] = buf[i];
+  }
+  n += words * 4U;
+  if (n)
+  {
+    LCD_IO_Start(n);
+  }
+  *ppData = pData;
+
+  return pixels * 2U;
+}
+
+/**
+ * @brief  Send RGB565 pixels to the LCD GRAM as RGB444.
+ * @param  ppData    pointer to the pixels.
+ * @param  Length    length in RGB565 bytes.
+ * @param  BigEndian pixels are high byte first, as staged by the driver
+ * @retval Error status
+ */
+static int32_t LCD_IO_SendPixels444(const uint8_t **ppData, uint32_t Length, uint8_t BigEndian)
+{
+  if (Length & 1U)
+    return BSP_ERROR_WRONG_PARAM;
+
+  /* Set LCD data/command line DC to High */
+  LCD_IO_WaitIdle();
+  LCD_IO_SetDC(GPIO_PIN_SET);
+
+  while (Length)
+  {
+    while (SPI1.cmd.usr)
+      ;
+    Length -= LCD_IO_LoadPixels444(ppData, Length, BigEndian);
+  }
+
+  return BSP_ERROR_NONE;
+}
+
+/**
+ * @brief  Send one pixel repeatedly to the LCD GRAM as RGB444.
+ * @note   A pixel pair is 3 bytes, so the FIFO pattern repeats every 3 words.
+ * @param  pData pointer to the pixel, 2 bytes in panel byte order.
+ * @param  Length length of data to write in bytes.
+ * @retval Error status
+ */
+static int32_t LCD_IO_FillPixels444(const uint8_t *pData, uint32_t Length)
+{
+  const uint8_t *first = pData;
+  uint32_t pattern[3];
+  uint32_t pixels = Length / 2U;
+  uint32_t c, p, n, i;
+
+  /* Set LCD data/command line DC to High */
+  LCD_IO_WaitIdle();
+  LCD_IO_SetDC(GPIO_PIN_SET);
+
+  /* Complete a pair left open by the previous data */
+  if (pixels && Lcd_Io->Pack.Pending)
+  {
+    LCD_IO_LoadPixels444(&first, 2U, 1U);
+    pixels--;
+  }
+
+  c = LCD_IO_To444((pData[0] << 8) | pData[1]);
+  p = (c << 12) | c;
+  pattern[0] = __builtin_bswap32((p << 8) | (p >> 16));
+  pattern[1] = __builtin_bswap32((p << 16) | (p >> 8));
+  pattern[2] = __builtin_bswap32((p << 24) | p);
+  while (pixels >= 2U)
+  {
+    n = (pixels > LCD_IO_PACK_PIXELS) ? LCD_IO_PACK_PIXELS : (pixels & ~1U);
+    while (SPI1.cmd.usr)
+      ;
+    for (i = 0; i < (n * 3U / 2U + 3U) / 4U; i++)
+    {
+      SPI1.data_buf[i] = pattern[i % 3U];
+    }
+    LCD_IO_Start(n * 3U / 2U);
+    pixels -= n;
+  }
+  if (pixels)
+  {
+    Lcd_Io->Pack.Carry = (uint16_t)c;
+    Lcd_Io->Pack.Pending = 1U;
+  }
+
+  return BSP_ERROR_NONE;
+}
+
+/**
+ * @brief  Send the unpaired last pixel of an RGB444 stream.
+ * @note   Called with the bus idle before a command ends the stream. The 4
+ *         padding bits start a pixel the panel never completes.
+ * @retval None
+ */
+static void LCD_IO_FlushCarry(void)
+{
+  uint8_t last[2];
+
+  if (Lcd_Io->Pack.Pending)
+  {
+    last[0] = (uint8_t)(Lcd_Io->Pack.Carry >> 4);
+    last[1] = (uint8_t)(Lcd_Io->Pack.Carry << 4);
+    Lcd_Io->Pack.Pending = 0U;
+    LCD_IO_SetDC(GPIO_PIN_SET);
+    LCD_IO_Transmit(last, 2U);
+    LCD_IO_WaitIdle();
+  }
+}
+
+/**
+ * @brief  Make a panel the one the IO functions talk to before its driver
+ *         object is used.
+ * @note   A background transfer of the other panel is let run to its end first.
+ *         The caller only blocks for the bus, so one panel's pixels can be in
+ *         flight while the other's are rendered. The bus arbiter switches CS
+ *         on the panel's next transfer.
+ * @param  Instance LCD Instance
+ * @retval Driver object of the panel
+ */
+static void *LCD_IO_Select(uint32_t Instance)
+{
+  LCD_IO_Dev_t *dev = &Lcd_Dev[Instance];
+
+  if (Lcd_Io != dev)
+  {
+    if (Lcd_Io != NULL)
+    {
+      LCD_IO_WaitIdle();
+      if (Lcd_Io->Pack.Pending)
+      {
+        LCD_IO_Begin();
+        LCD_IO_FlushCarry();
+        LCD_IO_End();
+      }
+      if (Lcd_Io->DcPin != dev->DcPin)
+      {
+        Lcd_DcLevel = 0xFFU;
+      }
+    }
+    Lcd_Io = dev;
+  }
+
+  return &ST7735Obj[Instance];
+}
+
+/**
+ * @brief  Take the bus for the selected panel, the arbiter sets up its CS.
+ * @note   The IO calls of the driver are never nested. Taking the bus while
+ *         the panel's own background transfer runs waits for its end.
+ * @retval None
+ */
+static void LCD_IO_Begin(void)
+{
+  SPI_BUS_Acquire(Lcd_Io->BusDev);
+  Lcd_Async.Held = 1U;
+}
+
+/**
+ * @brief  Give the bus up at the end of an IO call, or leave it to the SPI
+ *         interrupt when a background transfer was started.
+ * @retval None
+ */
+static void LCD_IO_End(void)
+{
+  uint8_t release;
+
+  portENTER_CRITICAL();
+  Lcd_Async.Held = 0U;
+  release = !Lcd_Async.Busy;
+  portEXIT_CRITICAL();
+
+  if (release)
+  {
+    SPI_BUS_Release(Lcd_Io->BusDev);
+  }
+}
+
+/* Driver IO functions: the raw ones with the bus taken around them */
+static int32_t LCD_IO_BusWriteReg(uint8_t Reg, uint8_t *pData, uint32_t Length)
+{
+  int32_t ret;
+
+  LCD_IO_Begin();
+  ret = LCD_IO_WriteReg(Reg, pData, Length);
+  LCD_IO_End();
+
+  return ret;
+}
+
+static int32_t LCD_IO_BusSendData(uint8_t *pData, uint32_t Length)
+{
+  int32_t ret;
+
+  LCD_IO_Begin();
+  ret = LCD_IO_SendData(pData, Length);
+  LCD_IO_End();
+
+  return ret;
+}
+
+static int32_t LCD_IO_BusSendPixels(uint8_t *pData, uint32_t Length)
+{
+  int32_t ret;
+
+  LCD_IO_Begin();
+  ret = LCD_IO_SendPixels(pData, Length);
+  LCD_IO_End();
+
+  return ret;
+}
+
+static int32_t LCD_IO_BusSendPixelsAsync(uint8_t *pData, uint32_t Length)
+{
+  int32_t ret;
+
+  LCD_IO_Begin();
+  ret = LCD_IO_SendPixelsAsync(pData, Length);
+  LCD_IO_End();
+
+  return ret;
+}
+
+static int32_t LCD_IO_BusFillPixels(uint8_t *pData, uint32_t Length)
+{
+  int32_t ret;
+
+  LCD_IO_Begin();
+  ret = LCD_IO_FillPixels(pData, Length);
+  LCD_IO_End();
+
+  return ret;
+}
+
+/**
+ * @brief  Load the next FIFO of the background transfer.
+ * @retval true when the last pixel has been loaded
+ */
+static bool IRAM_ATTR LCD_IO_LoadNext(void)
+{
+  uint32_t chunk;
+
+  if (Lcd_Io->Pack.Enabled)
+  {
+    chunk = LCD_IO_LoadPixels444(&Lcd_Async.pData, Lcd_Async.Length, 0U);
+  }
+  else if (Lcd_Io->pLut != NULL)
+  {
+    chunk = (Lcd_Async.Length > LCD_SPI_FIFO_SIZE) ? LCD_SPI_FIFO_SIZE : Lcd_Async.Length;
+    LCD_IO_LoadPixels8(Lcd_Async.pData, chunk);
+    Lcd_Async.pData += chunk / 2U;
+  }
+  else
+  {
+    chunk = (Lcd_Async.Length > LCD_SPI_FIFO_SIZE) ? LCD_SPI_FIFO_SIZE : Lcd_Async.Length;
+    LCD_IO_LoadPixels(Lcd_Async.pData, chunk);
+    Lcd_Async.pData += chunk;
+  }
+  Lcd_Async.Length -= chunk;
+
+  return (0U == Lcd_Async.Length);
+}
+
+/**
+ * @brief  Start streaming RGB565 pixels to the LCD GRAM from the SPI interrupt.
+ * @param  pData pointer to the pixels, kept until LCD_SignalTransferDone().
+ * @param  Length length of data to write in bytes.
+ * @retval Error status
+ */
+static int32_t LCD_IO_SendPixelsAsync(uint8_t *pData, uint32_t Length)
+{
+  bool done;
+
+  if ((NULL == pData) || (Length & 1U))
+    return BSP_ERROR_WRONG_PARAM;
+
+  /* Set LCD data/command line DC to High */
+  LCD_IO_WaitIdle();
+  LCD_IO_SetDC(GPIO_PIN_SET);
+
+  if (!Length)
+  {
+    LCD_SignalTransferDone(Lcd_Async.Instance);
+    return BSP_ERROR_NONE;
+  }
+
+  portENTER_CRITICAL();
+  Lcd_Async.pData = pData;
+  Lcd_Async.Length = Length;
+  Lcd_Async.Busy = 1U;
+  done = LCD_IO_LoadNext();
+  if (done)
+  {
+    Lcd_Async.Busy = 0U;
+  }
+  portEXIT_CRITICAL();
+
+  /* The whole bitmap fitted in the FIFO: pData is free already */
+  if (done)
+  {
+    LCD_SignalTransferDone(Lcd_Async.Instance);
+  }
+
+  return BSP_ERROR_NONE;
+}
+
+/**
+ * @brief  HSPI event callback, registered as spi_config_t.event_cb.
+ * @note   Every completed transaction raises SPI_TRANS_DONE_EVENT, including
+ *         the synchronous ones and the one still pending when a background
+ *         transfer starts. The FIFO is only refilled once the bus is really idle,
+ *         so a stale event is simply ignored.
+ * @param  event SPI event
+ * @param  arg   pointer to the interrupt status
+ * @retval None
+ */
+void IRAM_ATTR LCD_IO_SpiEventCallback(int event, void *arg)
+{
+  if ((SPI_TRANS_DONE_EVENT != event) || (NULL == arg) || !(*(uint32_t *)arg & SPI_TRANS_DONE))
+    return;
+
+  if (!Lcd_Async.Busy || SPI1.cmd.usr)
+    return;
+
+  if (LCD_IO_LoadNext())
+  {
+    /* The last pixels are in the FIFO, the source buffer can be reused */
+    Lcd_Async.Busy = 0U;
+    if (!Lcd_Async.Held)
+    {
+      SPI_BUS_ReleaseFromISR(Lcd_Io->BusDev);
+    }
+    LCD_SignalTransferDone(Lcd_Async.Instance);
+  }
+}
+
+/**
+ * @brief  Background transfer completed callback.
+ * @note   Runs in interrupt context. Overridden by the graphics port.
+ * @param  Instance LCD Instance
+ * @retval None
+ */
+__attribute__((weak)) void LCD_SignalTransferDone(uint32_t Instance)
+{
+  UNUSED(Instance);
+}
+
 /**
  * @}
  */
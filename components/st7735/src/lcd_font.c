@@ -0,0 +1,339 @@
+/**
+ ******************************************************************************
+ * @file    lcd_font.c
+ * @brief   Double-byte (GBK) font streamed from the file system. Provides
+ *          ST7735_GetWideGlyph() to the ST7735 driver, see lcd_font.h for the
+ *          file layout.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "lcd_font.h"
+#include "lcd.h"
+#include "st7735.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** @defgroup LCD_FONT_Private_Defines LCD Font Private Defines
+ * @{
+ */
+#define LCD_FONT_HEADER_SIZE 8U
+#define LCD_FONT_RUN_SIZE 6U
+#define LCD_FONT_GLYPH_MAX 128U /* Up to 32 x 32 */
+/**
+ * @}
+ */
+
+/** @defgroup LCD_FONT_Private_Types LCD Font Private Types
+ * @{
+ */
+typedef struct
+{
+  uint16_t First; /* First GBK code of the run */
+  uint16_t Count; /* Codes in the run */
+  uint16_t Glyph; /* Glyph number of First */
+} LCD_FontRun_t;
+
+typedef struct
+{
+  uint8_t Data[LCD_FONT_PAGE_SIZE];
+  uint32_t Page;  /* File offset / LCD_FONT_PAGE_SIZE */
+  uint32_t Used;  /* Lookup that used it last */
+  uint8_t Valid;
+} LCD_FontPage_t;
+
+typedef struct
+{
+  FILE *File;
+  LCD_FontRun_t *pRuns;
+  uint32_t Runs;
+  uint32_t Width;
+  uint32_t Height;
+  uint32_t GlyphBytes;
+  uint32_t DataOffset;
+  uint32_t Stamp;
+  LCD_FontPage_t Page[LCD_FONT_PAGES];
+  uint8_t Glyph[LCD_FONT_GLYPH_MAX];
+  LCD_FontStats_t Stats;
+} LCD_Font_t;
+/**
+ * @}
+ */
+
+/** @defgroup LCD_FONT_Private_Variables LCD Font Private Variables
+ * @{
+ */
+static LCD_Font_t Font;
+/**
+ * @}
+ */
+
+/** @defgroup LCD_FONT_Private_Functions LCD Font Private Functions
+ * @{
+ */
+static inline uint32_t LCD_FontGetCCount(void)
+{
+  uint32_t ccount;
+
+  __asm__ __volatile__("rsr %0, ccount" : "=a"(ccount));
+  return ccount;
+}
+
+static inline uint16_t LCD_FontGet16(const uint8_t *p)
+{
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/**
+ * @brief  Get a page of the font file, reading it into the least recently
+ *         used slot on a miss.
+ * @param  Page file offset / LCD_FONT_PAGE_SIZE
+ * @retval Page data, NULL on a read error
+ */
+static const uint8_t *LCD_FontGetPage(uint32_t Page)
+{
+  LCD_FontPage_t *slot = &Font.Page[0];
+  uint32_t i;
+
+  for (i = 0; i < LCD_FONT_PAGES; i++)
+  {
+    if (Font.Page[i].Valid && (Font.Page[i].Page == Page))
+    {
+      Font.Page[i].Used = Font.Stamp;
+      Font.Stats.PageHits++;
+      return Font.Page[i].Data;
+    }
+    if (!Font.Page[i].Valid || ((int32_t)(Font.Page[i].Used - slot->Used) < 0))
+    {
+      slot = &Font.Page[i];
+      if (!slot->Valid)
+      {
+        break;
+      }
+    }
+  }
+
+  Font.Stats.PageMisses++;
+  slot->Valid = 0;
+  if ((fseek(Font.File, (long)(Page * LCD_FONT_PAGE_SIZE), SEEK_SET) != 0) ||
+      (fread(slot->Data, 1, LCD_FONT_PAGE_SIZE, Font.File) == 0))
+  {
+    return NULL;
+  }
+  slot->Page = Page;
+  slot->Used = Font.Stamp;
+  slot->Valid = 1;
+
+  return slot->Data;
+}
+
+/**
+ * @brief  Read bytes of the font file through the page cache.
+ * @param  Offset file offset
+ * @param  pData  destination
+ * @param  Length number of bytes
+ * @retval BSP status
+ */
+static int32_t LCD_FontRead(uint32_t Offset, uint8_t *pData, uint32_t Length)
+{
+  const uint8_t *page;
+  uint32_t in_page, chunk;
+
+  while (Length)
+  {
+    page = LCD_FontGetPage(Offset / LCD_FONT_PAGE_SIZE);
+    if (NULL == page)
+    {
+      return BSP_ERROR_PERIPH_FAILURE;
+    }
+    in_page = Offset % LCD_FONT_PAGE_SIZE;
+    chunk = LCD_FONT_PAGE_SIZE - in_page;
+    if (chunk > Length)
+    {
+      chunk = Length;
+    }
+    memcpy(pData, page + in_page, chunk);
+    pData += chunk;
+    Offset += chunk;
+    Length -= chunk;
+  }
+
+  return BSP_ERROR_NONE;
+}
+
+/**
+ * @brief  Find the glyph number of a GBK code in the run index.
+ * @param  Code  GBK code, lead byte in the high byte
+ * @param  Glyph glyph number
+ * @retval BSP status
+ */
+static int32_t LCD_FontFind(uint16_t Code, uint32_t *Glyph)
+{
+  uint32_t lo = 0, hi = Font.Runs, mid;
+  const LCD_FontRun_t *run;
+
+  while (lo < hi)
+  {
+    mid = (lo + hi) / 2U;
+    run = &Font.pRuns[mid];
+    if (Code < run->First)
+    {
+      hi = mid;
+    }
+    else if (Code >= (uint32_t)(run->First + run->Count))
+    {
+      lo = mid + 1U;
+    }
+    else
+    {
+      *Glyph = run->Glyph + (Code - run->First);
+      return BSP_ERROR_NONE;
+    }
+  }
+
+  return BSP_ERROR_WRONG_PARAM;
+}
+/**
+ * @}
+ */
+
+/** @defgroup LCD_FONT_Exported_Functions LCD Font Exported Functions
+ * @{
+ */
+/**
+ * @brief  Open a font file and load its index.
+ * @param  Path font file, usually LCD_FONT_PATH
+ * @retval BSP status
+ */
+int32_t LCD_FontOpen(const char *Path)
+{
+  uint8_t header[LCD_FONT_HEADER_SIZE];
+  uint8_t run[LCD_FONT_RUN_SIZE];
+  uint32_t i;
+
+  LCD_FontClose();
+
+  Font.File = fopen(Path, "rb");
+  if (NULL == Font.File)
+  {
+    return BSP_ERROR_PERIPH_FAILURE;
+  }
+  if ((fread(header, 1, sizeof(header), Font.File) != sizeof(header)) || (memcmp(header, "GFNT", 4) != 0))
+  {
+    LCD_FontClose();
+    return BSP_ERROR_WRONG_PARAM;
+  }
+
+  Font.Width = header[4];
+  Font.Height = header[5];
+  Font.Runs = LCD_FontGet16(&header[6]);
+  Font.GlyphBytes = ((Font.Width + 7U) / 8U) * Font.Height;
+  Font.DataOffset = LCD_FONT_HEADER_SIZE + (Font.Runs * LCD_FONT_RUN_SIZE);
+  if (!Font.GlyphBytes || (Font.GlyphBytes > LCD_FONT_GLYPH_MAX))
+  {
+    LCD_FontClose();
+    return BSP_ERROR_WRONG_PARAM;
+  }
+
+  Font.pRuns = malloc(Font.Runs * sizeof(LCD_FontRun_t));
+  if ((NULL == Font.pRuns) && Font.Runs)
+  {
+    LCD_FontClose();
+    return BSP_ERROR_NO_INIT;
+  }
+  for (i = 0; i < Font.Runs; i++)
+  {
+    if (fread(run, 1, sizeof(run), Font.File) != sizeof(run))
+    {
+      LCD_FontClose();
+      return BSP_ERROR_WRONG_PARAM;
+    }
+    Font.pRuns[i].First = LCD_FontGet16(&run[0]);
+    Font.pRuns[i].Count = LCD_FontGet16(&run[2]);
+    Font.pRuns[i].Glyph = LCD_FontGet16(&run[4]);
+  }
+
+  return BSP_ERROR_NONE;
+}
+
+/**
+ * @brief  Close the font file and release the index.
+ * @retval None
+ */
+void LCD_FontClose(void)
+{
+  if (Font.File != NULL)
+  {
+    fclose(Font.File);
+    Font.File = NULL;
+  }
+  free(Font.pRuns);
+  Font.pRuns = NULL;
+  Font.Runs = 0;
+  LCD_FontFlush();
+}
+
+/**
+ * @brief  Drop the cached pages, the next lookups read from the file again.
+ * @retval None
+ */
+void LCD_FontFlush(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < LCD_FONT_PAGES; i++)
+  {
+    Font.Page[i].Valid = 0;
+  }
+}
+
+/**
+ * @brief  Get the font lookup counters.
+ * @param  Stats counters since boot
+ * @retval BSP status
+ */
+int32_t LCD_FontGetStats(LCD_FontStats_t *Stats)
+{
+  if (NULL == Stats)
+  {
+    return BSP_ERROR_WRONG_PARAM;
+  }
+  *Stats = Font.Stats;
+
+  return BSP_ERROR_NONE;
+}
+
+/**
+ * @brief  Get the bitmap of a GBK character from the font file.
+ * @note   Overrides the weak default of the ST7735 driver.
+ * @param  pCode  the two bytes of the character
+ * @param  size   font height
+ * @param  pBits  glyph bitmap, valid until the next call
+ * @param  Width  glyph width in pixels
+ * @retval ST7735_OK when the font has the character
+ */
+int32_t ST7735_GetWideGlyph(const uint8_t *pCode, uint8_t size, const uint8_t **pBits, uint32_t *Width)
+{
+  int32_t ret = ST7735_ERROR;
+  uint32_t start = LCD_FontGetCCount();
+  uint32_t glyph;
+
+  Font.Stats.Lookups++;
+  Font.Stamp++;
+  if ((Font.File != NULL) && (size == Font.Height) &&
+      (LCD_FontFind((uint16_t)((pCode[0] << 8) | pCode[1]), &glyph) == BSP_ERROR_NONE) &&
+      (LCD_FontRead(Font.DataOffset + (glyph * Font.GlyphBytes), Font.Glyph, Font.GlyphBytes) == BSP_ERROR_NONE))
+  {
+    *pBits = Font.Glyph;
+    *Width = Font.Width;
+    Font.Stats.Found++;
+    ret = ST7735_OK;
+  }
+  Font.Stats.Cycles += LCD_FontGetCCount() - start;
+
+  return ret;
+}
+/**
+ * @}
+ */
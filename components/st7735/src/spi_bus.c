@@ -0,0 +1,402 @@
+/**
+ ******************************************************************************
+ * @file    spi_bus.c
+ * @brief   HSPI bus arbiter: hands the bus to the waiting devices by priority
+ *          and switches clock, mode and CS between them, see spi_bus.h.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "spi_bus.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "esp8266/spi_struct.h"
+#include "esp8266/gpio_struct.h"
+
+/** @defgroup SPI_BUS_Private_Defines SPI Bus Private Defines
+ * @{
+ */
+#define SPI_BUS_HOST HSPI_HOST
+#define SPI_BUS_NONE 0xFFFFFFFFU
+/**
+ * @}
+ */
+
+/** @defgroup SPI_BUS_Private_Types SPI Bus Private Types
+ * @{
+ */
+typedef struct
+{
+  SPI_BUS_DevConfig_t Config;
+  SemaphoreHandle_t Grant; /* Given when the bus is handed over to the device */
+  uint32_t Ticket;         /* Arrival order while waiting, 0: not waiting */
+  SPI_BUS_Stats_t Stats;
+} SPI_BUS_Dev_t;
+
+typedef struct
+{
+  SPI_BUS_Dev_t Dev[SPI_BUS_DEVICES_MAX];
+  uint32_t Devices;
+  uint32_t Owner;   /* Device holding the bus, SPI_BUS_NONE: free */
+  uint32_t Current; /* Device clock, mode and CS are set up for */
+  uint32_t Tickets;
+} SPI_BUS_t;
+/**
+ * @}
+ */
+
+/** @defgroup SPI_BUS_Private_Variables SPI Bus Private Variables
+ * @{
+ */
+static SPI_BUS_t Bus = {.Owner = SPI_BUS_NONE, .Current = SPI_BUS_NONE};
+/**
+ * @}
+ */
+
+/** @defgroup SPI_BUS_Private_Functions SPI Bus Private Functions
+ * @{
+ */
+/**
+ * @brief  Pass the bus to the waiting device of highest priority, the one
+ *         that came first among equals, or free it.
+ * @note   Called in a critical section or from the SPI interrupt.
+ * @retval Semaphore to give to wake the new owner, NULL: none
+ */
+static SemaphoreHandle_t IRAM_ATTR SPI_BUS_Handover(void)
+{
+  SPI_BUS_Dev_t *dev, *next = NULL;
+  uint32_t i;
+
+  Bus.Owner = SPI_BUS_NONE;
+  for (i = 0; i < Bus.Devices; i++)
+  {
+    dev = &Bus.Dev[i];
+    if (dev->Ticket &&
+        ((NULL == next) ||
+         (dev->Config.Priority > next->Config.Priority) ||
+         ((dev->Config.Priority == next->Config.Priority) && ((int32_t)(dev->Ticket - next->Ticket) < 0))))
+    {
+      next = dev;
+      Bus.Owner = i;
+    }
+  }
+  if (NULL == next)
+  {
+    return NULL;
+  }
+  next->Ticket = 0U;
+
+  return next->Grant;
+}
+
+/**
+ * @brief  Set the bus up for a device taking it over from another one.
+ * @param  Handle device handle
+ * @retval None
+ */
+static void SPI_BUS_Switch(uint32_t Handle)
+{
+  const SPI_BUS_DevConfig_t *cfg = &Bus.Dev[Handle].Config;
+  spi_clk_div_t div;
+  spi_interface_t itf;
+
+  /* The previous device's last transaction may still be on the wire */
+  while (SPI1.cmd.usr)
+    ;
+
+  if ((Bus.Current != SPI_BUS_NONE) && (Bus.Dev[Bus.Current].Config.CsPin != SPI_BUS_CS_NONE))
+  {
+    GPIO.out_w1ts = 1U << Bus.Dev[Bus.Current].Config.CsPin;
+  }
+  if ((spi_get_clk_div(SPI_BUS_HOST, &div) == ESP_OK) && (div != cfg->ClkDiv))
+  {
+    div = cfg->ClkDiv;
+    spi_set_clk_div(SPI_BUS_HOST, &div);
+  }
+  if ((spi_get_interface(SPI_BUS_HOST, &itf) == ESP_OK) &&
+      ((itf.cpol != (cfg->Mode >> 1)) || (itf.cpha != (cfg->Mode & 1U))))
+  {
+    itf.cpol = cfg->Mode >> 1;
+    itf.cpha = cfg->Mode & 1U;
+    spi_set_interface(SPI_BUS_HOST, &itf);
+  }
+  if (cfg->CsPin != SPI_BUS_CS_NONE)
+  {
+    GPIO.out_w1tc = 1U << cfg->CsPin;
+  }
+  Bus.Current = Handle;
+}
+/**
+ * @}
+ */
+
+/** @defgroup SPI_BUS_Exported_Functions SPI Bus Exported Functions
+ * @{
+ */
+/**
+ * @brief  Add a device to the bus.
+ * @note   Its CS pin must be configured as a GPIO output, it is driven high
+ *         here. One task at a time may use a device handle. A device without
+ *         a CS pin driven here (hardware CS or tied low) sees every transaction
+ *         on the bus, so it can only be the only device.
+ * @param  pConfig bus set-up of the device
+ * @param  pHandle device handle
+ * @retval BSP status
+ */
+int32_t SPI_BUS_AddDevice(const SPI_BUS_DevConfig_t *pConfig, uint32_t *pHandle)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  SPI_BUS_Dev_t *dev;
+
+  if ((NULL == pConfig) || (NULL == pHandle) || (pConfig->Mode > 3U) || (pConfig->Priority > SPI_BUS_PRIO_HIGH))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else if (Bus.Devices >= SPI_BUS_DEVICES_MAX)
+  {
+    ret = BSP_ERROR_BUSY;
+  }
+  else if ((Bus.Devices != 0U) &&
+           ((pConfig->CsPin == SPI_BUS_CS_NONE) || (Bus.Dev[0].Config.CsPin == SPI_BUS_CS_NONE)))
+  {
+    ret = BSP_ERROR_BUSY;
+  }
+  else
+  {
+    dev = &Bus.Dev[Bus.Devices];
+    dev->Grant = xSemaphoreCreateBinary();
+    if (NULL == dev->Grant)
+    {
+      ret = BSP_ERROR_NO_INIT;
+    }
+    else
+    {
+      dev->Config = *pConfig;
+      if (pConfig->CsPin != SPI_BUS_CS_NONE)
+      {
+        GPIO.out_w1ts = 1U << pConfig->CsPin;
+      }
+      *pHandle = Bus.Devices++;
+    }
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Get the number of devices on the bus, handles are 0 .. n - 1.
+ * @retval Number of devices
+ */
+uint32_t SPI_BUS_GetDevices(void)
+{
+  return Bus.Devices;
+}
+
+/**
+ * @brief  Get the bus set-up of a device.
+ * @param  Handle  device handle
+ * @param  pConfig set-up given to SPI_BUS_AddDevice()
+ * @retval BSP status
+ */
+int32_t SPI_BUS_GetConfig(uint32_t Handle, SPI_BUS_DevConfig_t *pConfig)
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if ((Handle >= Bus.Devices) || (NULL == pConfig))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    *pConfig = Bus.Dev[Handle].Config;
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Get the bus counters of a device.
+ * @param  Handle device handle
+ * @param  pStats counters since boot
+ * @retval BSP status
+ */
+int32_t SPI_BUS_GetStats(uint32_t Handle, SPI_BUS_Stats_t *pStats)
+{
+  int32_t ret = BSP_ERROR_NONE;
+
+  if ((Handle >= Bus.Devices) || (NULL == pStats))
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    portENTER_CRITICAL();
+    *pStats = Bus.Dev[Handle].Stats;
+    portEXIT_CRITICAL();
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Take the bus for a transfer, waiting in the queue while another
+ *         device holds it.
+ * @note   Not from an interrupt. Taking the bus back costs nothing as long as
+ *         no other device used it in between.
+ * @param  Handle device handle
+ * @retval BSP status
+ */
+int32_t SPI_BUS_Acquire(uint32_t Handle)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  SPI_BUS_Dev_t *dev;
+  int64_t start;
+  uint32_t wait;
+  uint8_t queued = 0U;
+
+  if (Handle >= Bus.Devices)
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else
+  {
+    dev = &Bus.Dev[Handle];
+
+    portENTER_CRITICAL();
+    if (SPI_BUS_NONE == Bus.Owner)
+    {
+      Bus.Owner = Handle;
+    }
+    else
+    {
+      if (0U == ++Bus.Tickets)
+      {
+        Bus.Tickets = 1U;
+      }
+      dev->Ticket = Bus.Tickets;
+      queued = 1U;
+    }
+    portEXIT_CRITICAL();
+
+    dev->Stats.Acquires++;
+    if (queued)
+    {
+      start = esp_timer_get_time();
+      xSemaphoreTake(dev->Grant, portMAX_DELAY);
+      wait = (uint32_t)(esp_timer_get_time() - start);
+      dev->Stats.Contended++;
+      dev->Stats.WaitUs += wait;
+      if (wait > dev->Stats.MaxWaitUs)
+      {
+        dev->Stats.MaxWaitUs = wait;
+      }
+    }
+
+    if (Bus.Current != Handle)
+    {
+      SPI_BUS_Switch(Handle);
+    }
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Give the bus up after a transfer.
+ * @note   The last transaction may still be shifting out, the next device
+ *         waits for it before the bus is set up for it.
+ * @param  Handle device handle
+ * @retval None
+ */
+void SPI_BUS_Release(uint32_t Handle)
+{
+  SemaphoreHandle_t grant = NULL;
+
+  portENTER_CRITICAL();
+  if (Bus.Owner == Handle)
+  {
+    grant = SPI_BUS_Handover();
+  }
+  portEXIT_CRITICAL();
+
+  if (grant != NULL)
+  {
+    xSemaphoreGive(grant);
+  }
+}
+
+/**
+ * @brief  Give the bus up at the end of a background transfer.
+ * @param  Handle device handle
+ * @retval None
+ */
+void IRAM_ATTR SPI_BUS_ReleaseFromISR(uint32_t Handle)
+{
+  SemaphoreHandle_t grant = NULL;
+  BaseType_t woken = pdFALSE;
+
+  if (Bus.Owner == Handle)
+  {
+    grant = SPI_BUS_Handover();
+  }
+  if (grant != NULL)
+  {
+    xSemaphoreGiveFromISR(grant, &woken);
+    if (woken)
+    {
+      portYIELD_FROM_ISR();
+    }
+  }
+}
+
+/**
+ * @brief  Count a transaction started by the device holding the bus.
+ * @note   For devices writing the HSPI registers themselves, may be called
+ *         from the SPI interrupt.
+ * @param  Bytes bytes shifted by the transaction
+ * @retval None
+ */
+void IRAM_ATTR SPI_BUS_Account(uint32_t Bytes)
+{
+  SPI_BUS_Dev_t *dev;
+
+  if (Bus.Current < Bus.Devices)
+  {
+    dev = &Bus.Dev[Bus.Current];
+    dev->Stats.Transactions++;
+    dev->Stats.Bytes += Bytes;
+    dev->Stats.WireCycles += (uint64_t)Bytes * 8U * dev->Config.ClkDiv;
+  }
+}
+
+/**
+ * @brief  Run one spi_trans() transaction with the bus taken for it.
+ * @param  Handle device handle
+ * @param  pTrans transaction, see spi_trans()
+ * @retval BSP status
+ */
+int32_t SPI_BUS_Transfer(uint32_t Handle, spi_trans_t *pTrans)
+{
+  int32_t ret;
+
+  if (NULL == pTrans)
+  {
+    ret = BSP_ERROR_WRONG_PARAM;
+  }
+  else if ((ret = SPI_BUS_Acquire(Handle)) == BSP_ERROR_NONE)
+  {
+    if (spi_trans(SPI_BUS_HOST, pTrans) != ESP_OK)
+    {
+      ret = BSP_ERROR_PERIPH_FAILURE;
+    }
+    SPI_BUS_Account((pTrans->bits.cmd + pTrans->bits.addr + pTrans->bits.mosi + pTrans->bits.miso) / 8U);
+    SPI_BUS_Release(Handle);
+  }
+
+  return ret;
+}
+/**
+ * @}
+ */
@@ -21,6 +21,8 @@
 /* Includes ------------------------------------------------------------------*/
 #include "st7735.h"
 #include "tft_front.h"
+#include <stdlib.h>
+#include <string.h>
 // #include "stm32h7xx_hal.h"
 /** @addtogroup BSP
  * @{
@@ -39,12 +41,6 @@
 /** @defgroup ST7735_Private_Types Private Types
  * @{
  */
-typedef struct
-{
-  uint32_t Width;
-  uint32_t Height;
-  uint32_t Orientation;
-} ST7735_Ctx_t;
 /**
  * @}
  */
@@ -75,21 +71,70 @@ ST7735_LCD_Drv_t ST7735_LCD_Driver = {
         ST7735_DrawString,
         ST7735_GetXSize,
         ST7735_GetYSize,
+        ST7735_DrawBitmapAsync,
+        ST7735_FillRGBRectStride,
+        ST7735_DrawRect,
+        ST7735_SetScrollArea,
+        ST7735_SetScrollOffset,
+        ST7735_SetColorCoding,
+        ST7735_SetPowerMode,
+        ST7735_SetFrameRate,
+        ST7735_GetFrameRate,
+        ST7735_Sleep,
+        ST7735_Resume,
+        ST7735_FillRGBRectStrideAsync,
     },
 };
 
-/* The below table handle the different values to be set to Memory Data Access Control
-   depending on the orientation and pbm image writing where the data order is inverted
+/* Memory Data Access Control and RAM offset of the glass for each orientation,
+   both from the panel profile, see st7735_panel.h
 */
-static uint8_t OrientationTab[4][2] =
-    {
-        {0x40U, 0xC0U}, /* Portrait orientation choice of LCD screen               */
-        {0x80U, 0x00U}, /* Portrait rotated 180� orientation choice of LCD screen  */
-        {0x20U, 0x60U}, /* Landscape orientation choice of LCD screen              */
-        {0xE0U, 0xA0U}  /* Landscape rotated 180� orientation choice of LCD screen */
-};
+static const uint8_t OrientationTab[4] = ST7735_PANEL_MADCTL;
+static const uint8_t OffsetTab[4][2] = ST7735_PANEL_OFFSETS;
+
+/* Frame memory rows of the controller, from the panel profile */
+#define ST7735_FRAME_ROWS ST7735_PANEL_FRAME_ROWS
+#define ST7735_MADCTL_MY 0x80U
+
+/* Frame rate = fosc / ((RTNA x 2 + 40) x (LINE + FPA + BPA)), porches 1..63 */
+#define ST7735_FOSC_HZ 625000U
+#define ST7735_RTNA_MAX 15U
+#define ST7735_PORCH_MIN 1U
+#define ST7735_PORCH_MAX 63U
+#define ST7735_FRAME_RATE(rtna, fpa, bpa) \
+  (ST7735_FOSC_HZ / (((rtna) * 2U + 40U) * (ST7735_HEIGHT + (fpa) + (bpa))))
+
+/* Init table of the panel: number of commands, then for each command the
+   register, the number of arguments (| ST7735_INIT_DELAY when a delay byte
+   follows), the arguments and the delay in ms. COLMOD and DISPON are sent by
+   ST7735_Init().
+*/
+static const uint8_t ST7735_InitTab[] = {ST7735_PANEL_INIT_CMDS};
+
+/* Longest display line in pixels in any orientation, sizes the glyph line buffer */
+#define ST7735_LINE_MAX ((ST7735_WIDTH > ST7735_HEIGHT) ? ST7735_WIDTH : ST7735_HEIGHT)
+
+/* Glyph expanded to RGB565 in panel byte order, rows of size / 2 pixels */
+typedef struct
+{
+  uint8_t *pPixels; /* NULL: free entry */
+  uint32_t Colors;  /* fColor << 16 | bColor */
+  uint32_t Used;    /* Draw call that used it last */
+  uint8_t Char;
+  uint8_t Size;
+} ST7735_Glyph_t;
 
-static ST7735_Ctx_t ST7735Ctx;
+typedef struct
+{
+  ST7735_Glyph_t Entry[ST7735_GLYPH_CACHE_ENTRIES];
+  uint32_t Bytes; /* Pixel memory held, at most ST7735_GLYPH_CACHE_SIZE */
+  uint32_t Stamp; /* Draw call counter */
+  uint32_t Hits;
+  uint32_t Misses;
+} ST7735_GlyphCache_t;
+
+static ST7735_GlyphCache_t GlyphCache;
+static uint8_t ST7735_Line[2U * ST7735_LINE_MAX]; /* Text line buffer, panel byte order */
 /**
  * @}
  */
@@ -98,10 +143,21 @@ static ST7735_Ctx_t ST7735Ctx;
  * @{
  */
 static int32_t ST7735_SetDisplayWindow(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint32_t Width, uint32_t Height);
+static int32_t ST7735_SendInitTable(ST7735_Object_t *pObj, const uint8_t *pTable);
+static int32_t ST7735_FillWindow(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint32_t Width, uint32_t Height, uint32_t Color);
+static const uint8_t *ST7735_GetGlyph(uint8_t num, uint8_t size);
+static int32_t ST7735_BlitGlyphs(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, const uint8_t *pStr, uint32_t Count, uint8_t size, uint32_t fColor, uint32_t bColor);
+static int32_t ST7735_OverlayGlyph(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint8_t num, uint8_t size, uint32_t fColor);
+static void ST7735_ExpandGlyph(uint8_t *pDst, const uint8_t *pGlyph, uint8_t size, uint32_t fColor, uint32_t bColor);
+static const uint8_t *ST7735_CachedGlyph(uint8_t num, uint8_t size, uint32_t fColor, uint32_t bColor);
+static int32_t ST7735_BlitBits(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, const uint8_t *pBits, uint32_t Width, uint32_t Height, uint32_t fColor, uint32_t bColor);
 static int32_t ST7735_ReadRegWrap(void *Handle, uint8_t Reg, uint8_t *pData);
 static int32_t ST7735_WriteRegWrap(void *Handle, uint8_t Reg, uint8_t *pData, uint32_t Length);
 static int32_t ST7735_SendDataWrap(void *Handle, uint8_t *pData, uint32_t Length);
 static int32_t ST7735_RecvDataWrap(void *Handle, uint8_t *pData, uint32_t Length);
+static int32_t ST7735_SendPixelsWrap(void *Handle, uint8_t *pData, uint32_t Length);
+static int32_t ST7735_SendPixelsAsyncWrap(void *Handle, uint8_t *pData, uint32_t Length);
+static int32_t ST7735_FillPixelsWrap(void *Handle, uint8_t *pData, uint32_t Length);
 static int32_t ST7735_IO_Delay(ST7735_Object_t *pObj, uint32_t Delay);
 /**
  * @}
@@ -133,12 +189,19 @@ int32_t ST7735_RegisterBusIO(ST7735_Object_t *pObj, ST7735_IO_t *pIO)
     pObj->IO.ReadReg = pIO->ReadReg;
     pObj->IO.SendData = pIO->SendData;
     pObj->IO.RecvData = pIO->RecvData;
+    pObj->IO.SendPixels = pIO->SendPixels;
+    pObj->IO.SendPixelsAsync = pIO->SendPixelsAsync;
+    pObj->IO.FillPixels = pIO->FillPixels;
     pObj->IO.GetTick = pIO->GetTick;
+    pObj->IO.Delay = pIO->Delay;
 
     pObj->Ctx.ReadReg = ST7735_ReadRegWrap;
     pObj->Ctx.WriteReg = ST7735_WriteRegWrap;
     pObj->Ctx.SendData = ST7735_SendDataWrap;
     pObj->Ctx.RecvData = ST7735_RecvDataWrap;
+    pObj->Ctx.SendPixels = ST7735_SendPixelsWrap;
+    pObj->Ctx.SendPixelsAsync = ST7735_SendPixelsAsyncWrap;
+    pObj->Ctx.FillPixels = ST7735_FillPixelsWrap;
     pObj->Ctx.handle = pObj;
 
     if (pObj->IO.Init)
@@ -165,169 +228,82 @@ int32_t ST7735_Init(ST7735_Object_t *pObj,
   if (NULL == pObj)
     return ST7735_ERROR;
 
-  /* Out of sleep mode, 0 args, no delay */
-  tmp = 0x00U;
-  ret = st7735_write_reg(&pObj->Ctx, ST7735_SLEEP_OUT, &tmp, 1);
-  if (pObj->IO.Delay)
-    pObj->IO.Delay(120);
-  /* Frame rate ctrl - normal mode, 3 args:Rate = fosc/(1x2+40) * (LINE+2C+2D)*/
-  ret += st7735_write_reg(&pObj->Ctx, ST7735_FRAME_RATE_CTRL1, &tmp, 0);
-  tmp = 0x01U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x2CU;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x2DU;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-
-  /* Frame rate control - idle mode, 3 args:Rate = fosc/(1x2+40) * (LINE+2C+2D) */
-  tmp = 0x01U;
-  ret += st7735_write_reg(&pObj->Ctx, ST7735_FRAME_RATE_CTRL2, &tmp, 1);
-  tmp = 0x2CU;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x2DU;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-
-  /* Frame rate ctrl - partial mode, 6 args: Dot inversion mode, Line inversion mode */
-  tmp = 0x01U;
-  ret += st7735_write_reg(&pObj->Ctx, ST7735_FRAME_RATE_CTRL3, &tmp, 1);
-  tmp = 0x2CU;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x2DU;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x01U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x2CU;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x2DU;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-
-  /* Display inversion ctrl, 1 arg, no delay: No inversion */
-  tmp = 0x07U;
-  ret += st7735_write_reg(&pObj->Ctx, ST7735_FRAME_INVERSION_CTRL, &tmp, 1);
-
-  /* Power control, 3 args, no delay: -4.6V , AUTO mode */
-  tmp = 0xA2U;
-  ret += st7735_write_reg(&pObj->Ctx, ST7735_PWR_CTRL1, &tmp, 1);
-  tmp = 0x02U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x84U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-
-  /* Power control, 1 arg, no delay: VGH25 = 2.4C VGSEL = -10 VGH = 3 * AVDD */
-  tmp = 0xC5U;
-  ret += st7735_write_reg(&pObj->Ctx, ST7735_PWR_CTRL2, &tmp, 1);
-
-  /* Power control, 2 args, no delay: Opamp current small, Boost frequency */
-  tmp = 0x0AU;
-  ret += st7735_write_reg(&pObj->Ctx, ST7735_PWR_CTRL3, &tmp, 1);
-  tmp = 0x00U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-
-  /* Power control, 2 args, no delay: BCLK/2, Opamp current small & Medium low */
-  tmp = 0x8AU;
-  ret += st7735_write_reg(&pObj->Ctx, ST7735_PWR_CTRL4, &tmp, 1);
-  tmp = 0x2AU;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-
-  /* Power control, 2 args, no delay */
-  tmp = 0x8AU;
-  ret += st7735_write_reg(&pObj->Ctx, ST7735_PWR_CTRL5, &tmp, 1);
-  tmp = 0xEEU;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-
-  /* Power control, 1 arg, no delay */
-  tmp = 0x0EU;
-  ret += st7735_write_reg(&pObj->Ctx, ST7735_VCOMH_VCOML_CTRL1, &tmp, 1);
-
-  /* Don't invert display, no args, no delay */
-  ret += st7735_write_reg(&pObj->Ctx, ST7735_DISPLAY_INVERSION_OFF, &tmp, 0);
+  /* Power up and configure the panel, one burst per command */
+  ret = ST7735_SendInitTable(pObj, ST7735_InitTab);
 
   /* Set color mode, 1 arg, no delay */
-  ret += st7735_write_reg(&pObj->Ctx, ST7735_COLOR_MODE, (uint8_t *)&ColorCoding, 1);
-
-  /* Magical unicorn dust, 16 args, no delay */
-  tmp = 0x0FU;
-  ret += st7735_write_reg(&pObj->Ctx, ST7735_PV_GAMMA_CTRL, &tmp, 1);
-  tmp = 0x1AU;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x0FU;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x18U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x2FU;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x28U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x20U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x22U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x1FU;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x1BU;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x23U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x37U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x00U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x07U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x02U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x10U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-
-  /* Sparkles and rainbows, 16 args, no delay */
-  tmp = 0x0FU;
-  ret += st7735_write_reg(&pObj->Ctx, ST7735_NV_GAMMA_CTRL, &tmp, 1);
-  tmp = 0x1BU;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x0FU;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x17U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x33U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x2CU;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x29U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x2EU;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x30U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x30U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x39U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x3FU;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x00U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x07U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x03U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x10U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-
-  /* Normal display on, no args, no delay */
-  // tmp  = 0x00U;
-  // ret += st7735_write_reg(&pObj->Ctx, ST7735_NORMAL_DISPLAY_OFF, &tmp, 1);
-  /*EnaBLe test command */
-  tmp = 0x01U;
-  ret += st7735_write_reg(&pObj->Ctx, ST7735_EXT_CTRL, &tmp, 1);
-  /*DisaBLe ram power save mode*/
-  tmp = 0x00U;
-  ret += st7735_write_reg(&pObj->Ctx, 0xF6, &tmp, 1);
-  /* Main screen turn on, no delay */
-  ret += st7735_write_reg(&pObj->Ctx, ST7735_DISPLAY_ON, &tmp, 1);
+  ret += ST7735_SetColorCoding(pObj, ColorCoding);
+
+  /* Main screen turn on, no args, no delay */
+  ret += st7735_write_reg(&pObj->Ctx, ST7735_DISPLAY_ON, &tmp, 0);
 
   /* Set the display Orientation and the default display window */
   ret += ST7735_SetOrientation(pObj, Orientation);
 
+  /* Display modes and rate as left by the init table */
+  pObj->Panel.PowerMode = ST7735_POWER_NORMAL;
+  pObj->Panel.FrameRate = ST7735_PANEL_FRAME_RATE;
+
+  if (ret != ST7735_OK)
+  {
+    ret = ST7735_ERROR;
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Put the panel to sleep, it keeps its frame memory and registers.
+ * @note   ST7735_Resume() wakes it up again. The RESET line has to stay high
+ *         meanwhile, and SLPOUT may only follow 120 ms after SLPIN.
+ * @param  pObj Component object
+ * @retval Component status
+ */
+int32_t ST7735_Sleep(ST7735_Object_t *pObj)
+{
+  int32_t ret;
+  uint8_t tmp;
+
+  ret = st7735_write_reg(&pObj->Ctx, ST7735_SLEEP_IN, &tmp, 0);
+  (void)ST7735_IO_Delay(pObj, 5);
+
+  if (ret != ST7735_OK)
+  {
+    ret = ST7735_ERROR;
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Take over a panel put to sleep by ST7735_Sleep(), keeping its picture.
+ * @note   Replaces ST7735_Init() after a warm boot: no init table and no clear,
+ *         the registers kept their values. Pixel format and orientation are
+ *         sent again, they cost a few bytes and set up the driver state.
+ * @param  pObj Component object
+ * @param  ColorCoding RGB mode
+ * @param  Orientation Display orientation
+ * @retval Component status
+ */
+int32_t ST7735_Resume(ST7735_Object_t *pObj, uint32_t ColorCoding, uint32_t Orientation)
+{
+  int32_t ret;
+  uint8_t tmp;
+
+  if (NULL == pObj)
+    return ST7735_ERROR;
+
+  /* Sleep out, 5 ms before the next command */
+  ret = st7735_write_reg(&pObj->Ctx, ST7735_SLEEP_OUT, &tmp, 0);
+  (void)ST7735_IO_Delay(pObj, 5);
+
+  ret += ST7735_SetColorCoding(pObj, ColorCoding);
+  ret += ST7735_SetOrientation(pObj, Orientation);
+
+  /* The frame rate is not read back, SetFrameRate() tells it again */
+  pObj->Panel.PowerMode = ST7735_POWER_NORMAL;
+  pObj->Panel.FrameRate = ST7735_PANEL_FRAME_RATE;
+
   if (ret != ST7735_OK)
   {
     ret = ST7735_ERROR;
@@ -390,9 +366,8 @@ int32_t ST7735_DisplayOn(ST7735_Object_t *pObj)
   (void)ST7735_IO_Delay(pObj, 10);
   ret += st7735_write_reg(&pObj->Ctx, ST7735_DISPLAY_ON, &tmp, 0);
   (void)ST7735_IO_Delay(pObj, 10);
-  ret += st7735_write_reg(&pObj->Ctx, ST7735_MADCTL, &tmp, 0);
-  tmp = 0xC0U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
+  tmp = OrientationTab[pObj->Panel.Orientation] | ST7735_PANEL_COLOR_ORDER;
+  ret += st7735_write_reg(&pObj->Ctx, ST7735_MADCTL, &tmp, 1);
   if (ret != ST7735_OK)
   {
     ret = ST7735_ERROR;
@@ -415,9 +390,8 @@ int32_t ST7735_DisplayOff(ST7735_Object_t *pObj)
   (void)ST7735_IO_Delay(pObj, 10);
   ret += st7735_write_reg(&pObj->Ctx, ST7735_DISPLAY_OFF, &tmp, 0);
   (void)ST7735_IO_Delay(pObj, 10);
-  ret += st7735_write_reg(&pObj->Ctx, ST7735_MADCTL, &tmp, 0);
-  tmp = 0xC0U;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
+  tmp = OrientationTab[pObj->Panel.Orientation] | ST7735_PANEL_COLOR_ORDER;
+  ret += st7735_write_reg(&pObj->Ctx, ST7735_MADCTL, &tmp, 1);
   if (ret != ST7735_OK)
   {
     ret = ST7735_ERROR;
@@ -471,21 +445,40 @@ int32_t ST7735_SetOrientation(ST7735_Object_t *pObj, uint32_t Orientation)
   if ((Orientation == ST7735_ORIENTATION_PORTRAIT) ||
       (Orientation == ST7735_ORIENTATION_PORTRAIT_ROT180))
   {
-    ST7735Ctx.Width = ST7735_WIDTH;
-    ST7735Ctx.Height = ST7735_HEIGHT;
+    pObj->Panel.Width = ST7735_WIDTH;
+    pObj->Panel.Height = ST7735_HEIGHT;
   }
   else
   {
-    ST7735Ctx.Width = ST7735_HEIGHT;
-    ST7735Ctx.Height = ST7735_WIDTH;
+    pObj->Panel.Width = ST7735_HEIGHT;
+    pObj->Panel.Height = ST7735_WIDTH;
+  }
+
+  /* Scroll and partial areas are defined for the old row order, NORON leaves both modes */
+  if ((pObj->Panel.ScrollVsa != 0U) || (pObj->Panel.PowerMode == ST7735_POWER_PARTIAL))
+  {
+    ret += st7735_write_reg(&pObj->Ctx, ST7735_NORMAL_DISPLAY_OFF, &tmp, 0);
+    pObj->Panel.ScrollVsa = 0U;
+    if (pObj->Panel.PowerMode == ST7735_POWER_PARTIAL)
+    {
+      pObj->Panel.PowerMode = ST7735_POWER_NORMAL;
+    }
   }
 
-  ret = ST7735_SetDisplayWindow(pObj, 0U, 0U, ST7735Ctx.Width, ST7735Ctx.Height);
+  /* RAM offset of the glass, and the first frame memory row it shows in
+     portrait where MY counts the rows from the other end */
+  pObj->Panel.XOffset = OffsetTab[Orientation][0];
+  pObj->Panel.YOffset = OffsetTab[Orientation][1];
+  pObj->Panel.RowStart = (OrientationTab[Orientation] & ST7735_MADCTL_MY)
+                             ? (ST7735_FRAME_ROWS - ST7735_HEIGHT - OffsetTab[Orientation][1])
+                             : OffsetTab[Orientation][1];
 
-  tmp = OrientationTab[Orientation][1];
+  ret += ST7735_SetDisplayWindow(pObj, 0U, 0U, pObj->Panel.Width, pObj->Panel.Height);
+
+  tmp = OrientationTab[Orientation] | ST7735_PANEL_COLOR_ORDER;
   ret += st7735_write_reg(&pObj->Ctx, ST7735_MADCTL, &tmp, 1);
 
-  ST7735Ctx.Orientation = Orientation;
+  pObj->Panel.Orientation = Orientation;
 
   if (ret != ST7735_OK)
   {
@@ -505,7 +498,7 @@ int32_t ST7735_SetOrientation(ST7735_Object_t *pObj, uint32_t Orientation)
 int32_t ST7735_GetOrientation(ST7735_Object_t *pObj, uint32_t *Orientation)
 {
 
-  *Orientation = ST7735Ctx.Orientation;
+  *Orientation = pObj->Panel.Orientation;
 
   return ST7735_OK;
 }
@@ -519,33 +512,47 @@ int32_t ST7735_GetOrientation(ST7735_Object_t *pObj, uint32_t *Orientation)
  */
 int32_t ST7735_SetCursor(ST7735_Object_t *pObj, uint32_t Start_Xpos, uint32_t Start_Ypos, uint32_t End_Xpos, uint32_t End_Ypos)
 {
-  int32_t ret;
-  uint8_t tmp;
-  /* Column addr set, 4 args, no delay: XSTART = Xpos, XEND = (Xpos + Width - 1) */
-  ret = st7735_write_reg(&pObj->Ctx, ST7735_CASET, &tmp, 0);
-  tmp = 0x02;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = Start_Xpos + 2;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x02;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = End_Xpos + 2;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
+  int32_t ret = ST7735_OK;
+  uint8_t pdata[4];
 
-  /* Row addr set, 4 args, no delay: YSTART = Ypos, YEND = (Ypos + Height - 1) */
-  ret += st7735_write_reg(&pObj->Ctx, ST7735_RASET, &tmp, 0);
-  tmp = 0x01;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = Start_Ypos + 1;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = 0x01;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  tmp = End_Ypos + 1;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  ret += st7735_write_reg(&pObj->Ctx, ST7735_WRITE_RAM, &tmp, 0);
+  pObj->Panel.Windows++;
+
+  /* Column addr set, 4 args in one burst: XSTART = Xpos, XEND = (Xpos + Width - 1) */
+  if (!pObj->Panel.ColumnValid || (Start_Xpos != pObj->Panel.XStart) || (End_Xpos != pObj->Panel.XEnd))
+  {
+    pdata[0] = (uint8_t)((Start_Xpos + pObj->Panel.XOffset) >> 8);
+    pdata[1] = (uint8_t)(Start_Xpos + pObj->Panel.XOffset);
+    pdata[2] = (uint8_t)((End_Xpos + pObj->Panel.XOffset) >> 8);
+    pdata[3] = (uint8_t)(End_Xpos + pObj->Panel.XOffset);
+    ret += st7735_write_reg(&pObj->Ctx, ST7735_CASET, pdata, 4);
+    pObj->Panel.XStart = Start_Xpos;
+    pObj->Panel.XEnd = End_Xpos;
+    pObj->Panel.ColumnValid = (ret == ST7735_OK);
+    pObj->Panel.WindowTransfers += 2U;
+  }
+
+  /* Row addr set, 4 args in one burst: YSTART = Ypos, YEND = (Ypos + Height - 1) */
+  if (!pObj->Panel.RowValid || (Start_Ypos != pObj->Panel.YStart) || (End_Ypos != pObj->Panel.YEnd))
+  {
+    pdata[0] = (uint8_t)((Start_Ypos + pObj->Panel.YOffset) >> 8);
+    pdata[1] = (uint8_t)(Start_Ypos + pObj->Panel.YOffset);
+    pdata[2] = (uint8_t)((End_Ypos + pObj->Panel.YOffset) >> 8);
+    pdata[3] = (uint8_t)(End_Ypos + pObj->Panel.YOffset);
+    ret += st7735_write_reg(&pObj->Ctx, ST7735_RASET, pdata, 4);
+    pObj->Panel.YStart = Start_Ypos;
+    pObj->Panel.YEnd = End_Ypos;
+    pObj->Panel.RowValid = (ret == ST7735_OK);
+    pObj->Panel.WindowTransfers += 2U;
+  }
+
+  /* RAMWR always restarts the write pointer at the top left of the window */
+  ret += st7735_write_reg(&pObj->Ctx, ST7735_WRITE_RAM, pdata, 0);
+  pObj->Panel.WindowTransfers++;
 
   if (ret != ST7735_OK)
   {
+    pObj->Panel.ColumnValid = 0U;
+    pObj->Panel.RowValid = 0U;
     ret = ST7735_ERROR;
   }
 
@@ -553,166 +560,74 @@ int32_t ST7735_SetCursor(ST7735_Object_t *pObj, uint32_t Start_Xpos, uint32_t St
 }
 
 /**
- * @brief  Displays an ASCII character.
- * @param  pObj Component object
- * @param  Xpos specifies the X position.
- * @param  Ypos specifies the Y position.
- * @param  num  Characters displayed.
- * @param  size Word size.
- * @param  fColor ForeColor.
- * @param  bColor Background Color.
- * @param  mode   display mode.
+ * @brief  Set the interface pixel format.
+ * @note   Only the bus format changes, the frame memory keeps its content.
+ * @param  pObj        Component object
+ * @param  ColorCoding ST7735_FORMAT_RBG444, ST7735_FORMAT_RBG565 or ST7735_FORMAT_RBG666
  * @retval The component status
  */
-int32_t ST7735_DrawChar(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint8_t num, uint8_t size, uint32_t fColor, uint32_t bColor, uint8_t mode)
+int32_t ST7735_SetColorCoding(ST7735_Object_t *pObj, uint32_t ColorCoding)
 {
   int32_t ret = ST7735_OK;
-  uint8_t ctemp = 0;
-  uint16_t Ystart = Ypos;
-  /*得到字体一个字符对应点阵集所占的字节数*/
-  uint8_t csize = (size / 8 + ((size % 8) ? 1 : 0)) * (size / 2);
-  /*得到偏移后的值（ASCII字库是从空格开始取模，所以-' '就是对应字符的字库）*/
-  num = num - ' ';
-  for (uint8_t i = 0; i < csize; i++)
-  {
-    switch (size)
-    {
-    case 12U:
-      ctemp = asc2_1206[num][i]; // 调用1206字体
-      break;
-    case 16U:
-      ctemp = asc2_1608[num][i]; // 调用1608字体
-      break;
-    case 24U:
-      ctemp = asc2_2412[num][i]; // 调用2412字体
-      break;
-    case 32U:
-      ctemp = asc2_3216[num][i]; // 调用3216字体
-      break;
-    default:
-      ret = ST7735_ERROR; // 没有的字库
-      break;
-    }
+  uint8_t tmp = (uint8_t)ColorCoding;
 
-    for (uint8_t j = 0; j < 8U; j++)
-    {
-      if (ctemp & 0x80)
-      {
-        ST7735_SetPixel(pObj, Xpos, Ypos, fColor); // 字体 画点
-      }
-      else if (mode == ST7735_NOTOVERLAY_DISPLAY)
-      {
-        ST7735_SetPixel(pObj, Xpos, Ypos, bColor); // 背景 画点
-      }
-      ctemp <<= 1U;
-      Ypos++;
-      if (Ypos >= ST7735Ctx.Height) // 超出屏幕高度(底)
-      {
-        ret = ST7735_ERROR;
-        break;
-      }
-      if ((Ypos - Ystart) == size)
-      {
-        Ypos = Ystart;
-        Xpos++;
-        if (Xpos >= ST7735Ctx.Width) // 超出屏幕宽度(宽)
-        {
-          ret = ST7735_ERROR;
-          break;
-        }
-        break;
-      }
-    }
+  if ((ColorCoding != ST7735_FORMAT_RBG444) && (ColorCoding != ST7735_FORMAT_RBG565) &&
+      (ColorCoding != ST7735_FORMAT_RBG666))
+  {
+    ret = ST7735_ERROR;
   }
-  return ret;
-}
-
-/**
- * @brief  Displays string.
- * @param  pObj Component object
- * @param  Xpos specifies the X position.
- * @param  Ypos specifies the Y position.
- * @param  string  an string.
- * @param  size Word size.
- * @param  fColor ForeColor.
- * @param  bColor Background Color.
- * @retval The component status
- */
-int32_t ST7735_DrawString(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint8_t *string, uint8_t size, uint32_t fColor, uint32_t bColor)
-{
-  int32_t ret = ST7735_OK;
-  uint8_t Xstart = Xpos;
-  /*没有到字符串尾部*/
-  while (*string != 0)
+  else if (st7735_write_reg(&pObj->Ctx, ST7735_COLOR_MODE, &tmp, 1) != ST7735_OK)
   {
-    /*如果这一行不够位置，就下一行 */
-    if (Xpos > (ST7735Ctx.Width - size))
-    {
-      Xpos = Xstart;
-      Ypos = Ypos + size;
-    } /*如果到了屏幕底部，就返回，不再输出*/
-    if (Ypos > (ST7735Ctx.Height - size))
-    {
-      ret = ST7735_ERROR;
-      break;
-    }
-    /*判断文字是ASCII还是汉字*/
-    if ((*string >= ' ') && (*string <= '~'))
-    { /*非叠加模式显示*/
-      ST7735_DrawChar(pObj, Xpos, Ypos, *string, size, fColor, bColor, ST7735_NOTOVERLAY_DISPLAY);
-      string++;
-      Xpos += size / 2U;
-    }
-    else // 汉字显示
-    {
-      // // 重要: 如果用的不是魔女开发板的字库, 就要修改或注释下面这一行, 这样就不影响ASCII英文字符的输出
-      // drawGBK(x, y, (u8*)pFont, size, fColor, bColor);
-      // pFont = pFont + 2;          // 下一个要显示的数据在内存中的位置
-      // x = x+size;              // 下一个要显示的数据在屏幕上的X位置
-    }
+    ret = ST7735_ERROR;
   }
+
   return ret;
 }
 
 /**
- * @brief  Displays a bitmap picture.
- * @param  pObj Component object
- * @param  Xpos Bmp X position in the LCD
- * @param  Ypos Bmp Y position in the LCD
- * @param  pBmp Bmp picture address.
+ * @brief  Define the vertical scroll area.
+ * @note   The panel scrolls along its 160-line side, so only in portrait. The
+ *         picture does not move until ST7735_SetScrollOffset() is called.
+ * @param  pObj   Component object
+ * @param  Top    lines fixed at the top of the display
+ * @param  Bottom lines fixed at the bottom of the display
  * @retval The component status
  */
-int32_t ST7735_DrawBitmap(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint32_t width, uint32_t height, uint8_t *pBmp)
+int32_t ST7735_SetScrollArea(ST7735_Object_t *pObj, uint32_t Top, uint32_t Bottom)
 {
   int32_t ret = ST7735_OK;
-  uint8_t pixel_val[2] = {0};
+  uint32_t tfa, vsa, bfa;
+  uint8_t pdata[6];
 
-  if ((Xpos + width) > ST7735Ctx.Width)
-  {
-    ret = ST7735_ERROR;
-  }
-  else if ((Ypos + height) > ST7735Ctx.Height)
+  if (((pObj->Panel.Orientation != ST7735_ORIENTATION_PORTRAIT) &&
+       (pObj->Panel.Orientation != ST7735_ORIENTATION_PORTRAIT_ROT180)) ||
+      ((Top + Bottom) >= ST7735_HEIGHT) || (pObj->Panel.PowerMode == ST7735_POWER_PARTIAL))
   {
     ret = ST7735_ERROR;
   }
   else
-  { /* Set Cursor */
-    if (ST7735_SetCursor(pObj, Xpos, Ypos, Xpos + width - 1U, Ypos + height - 1U) != ST7735_OK)
+  {
+    /* With MY set display line 0 is the last frame memory row: the fixed areas swap */
+    vsa = ST7735_HEIGHT - Top - Bottom;
+    tfa = ((OrientationTab[pObj->Panel.Orientation] & ST7735_MADCTL_MY) ? Bottom : Top) + pObj->Panel.RowStart;
+    bfa = ST7735_FRAME_ROWS - tfa - vsa;
+
+    pdata[0] = (uint8_t)(tfa >> 8);
+    pdata[1] = (uint8_t)tfa;
+    pdata[2] = (uint8_t)(vsa >> 8);
+    pdata[3] = (uint8_t)vsa;
+    pdata[4] = (uint8_t)(bfa >> 8);
+    pdata[5] = (uint8_t)bfa;
+    ret = st7735_write_reg(&pObj->Ctx, ST7735_VSCRDEF, pdata, 6);
+    if (ret == ST7735_OK)
     {
-      ret = ST7735_ERROR;
+      pObj->Panel.ScrollTfa = tfa;
+      pObj->Panel.ScrollVsa = vsa;
     }
-    else /*填充颜色*/
+    else
     {
-      for (uint16_t i = 0; i < width * height; i++)
-      { /*STM32属于小端存储，数据高位在前*/
-        pixel_val[0] = *(pBmp + i * 2 + 1);
-        pixel_val[1] = *(pBmp + i * 2);
-        if (st7735_send_data(&pObj->Ctx, pixel_val, sizeof(pixel_val)) != ST7735_OK)
-        {
-          ret = ST7735_ERROR;
-          break;
-        }
-      }
+      pObj->Panel.ScrollVsa = 0U;
+      ret = ST7735_ERROR;
     }
   }
 
@@ -720,44 +635,36 @@ int32_t ST7735_DrawBitmap(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, u
 }
 
 /**
- * @brief  Draws a full RGB rectangle
- * @param  pObj Component object
- * @param  Xpos   specifies the X position.
- * @param  Ypos   specifies the Y position.
- * @param  pData  pointer to RGB data
- * @param  Width  specifies the rectangle width.
- * @param  Height Specifies the rectangle height
+ * @brief  Scroll the area set by ST7735_SetScrollArea().
+ * @param  pObj   Component object
+ * @param  Offset drawing lines the content is moved up by, below the area height.
+ *                The first line of the area then shows drawing line Top + Offset.
  * @retval The component status
  */
-int32_t ST7735_FillRGBRect(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint8_t *pData, uint32_t Width, uint32_t Height)
+int32_t ST7735_SetScrollOffset(ST7735_Object_t *pObj, uint32_t Offset)
 {
   int32_t ret = ST7735_OK;
-  static uint8_t pdata[640];
-  uint8_t *rgb_data = pData;
-  uint32_t i, j;
+  uint32_t ssa;
+  uint8_t pdata[2];
 
-  if (((Xpos + Width) > ST7735Ctx.Width) || ((Ypos + Height) > ST7735Ctx.Height))
+  if ((pObj->Panel.ScrollVsa == 0U) || (Offset >= pObj->Panel.ScrollVsa))
   {
     ret = ST7735_ERROR;
-  } /* Set Cursor */
+  }
   else
   {
-    for (j = 0; j < Height; j++)
+    /* The start address counts frame memory rows, which run backwards when MY is set */
+    if (OrientationTab[pObj->Panel.Orientation] & ST7735_MADCTL_MY)
     {
-      for (i = 0; i < Width; i++)
-      {
-        pdata[2U * i] = (uint8_t)(*(rgb_data + 1U));
-        pdata[(2U * i) + 1U] = (uint8_t)(*rgb_data);
-        rgb_data += 2U;
-        if (ST7735_SetCursor(pObj, Xpos + i, Ypos + j, Xpos + i + 1U, Ypos + j + 1U) != ST7735_OK)
-        {
-          ret = ST7735_ERROR;
-        }
-        if (st7735_send_data(&pObj->Ctx, (uint8_t *)&pdata[0], 2U * Width) != ST7735_OK)
-        {
-          ret = ST7735_ERROR;
-        }
-      }
+      Offset = (pObj->Panel.ScrollVsa - Offset) % pObj->Panel.ScrollVsa;
+    }
+    ssa = pObj->Panel.ScrollTfa + Offset;
+
+    pdata[0] = (uint8_t)(ssa >> 8);
+    pdata[1] = (uint8_t)ssa;
+    if (st7735_write_reg(&pObj->Ctx, ST7735_VSCRSADD, pdata, 2) != ST7735_OK)
+    {
+      ret = ST7735_ERROR;
     }
   }
 
@@ -765,37 +672,75 @@ int32_t ST7735_FillRGBRect(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos,
 }
 
 /**
- * @brief  Draw Horizontal line.
- * @param  pObj Component object
- * @param  Xpos   specifies the X position.
- * @param  Ypos   specifies the Y position.
- * @param  Length specifies the Line length.
- * @param  Color  Specifies the RGB color in RGB565 format
+ * @brief  Switch between normal, idle and partial display mode.
+ * @note   Idle mode shows 8 colors only. Partial mode drives the lines Start
+ *         to End and leaves the others dark, in portrait only, and not with
+ *         a scroll area defined. Each mode has its own frame rate register,
+ *         all three follow ST7735_SetFrameRate().
+ * @param  pObj  Component object
+ * @param  Mode  ST7735_POWER_NORMAL, ST7735_POWER_IDLE or ST7735_POWER_PARTIAL
+ * @param  Start first display line shown in partial mode
+ * @param  End   last display line shown in partial mode
  * @retval The component status
  */
-int32_t ST7735_DrawHLine(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint32_t Length, uint32_t Color)
+int32_t ST7735_SetPowerMode(ST7735_Object_t *pObj, uint32_t Mode, uint32_t Start, uint32_t End)
 {
   int32_t ret = ST7735_OK;
-  uint32_t i;
-  static uint8_t pdata[640];
-
-  if ((Xpos + Length) > ST7735Ctx.Width)
-  {
-    ret = ST7735_ERROR;
-  } /* Set Cursor */
-  else if (ST7735_SetCursor(pObj, Xpos, Ypos, Xpos + Length, Ypos + 1) != ST7735_OK)
+  uint32_t psl, pel;
+  uint8_t pdata[4];
+
+  if ((Mode > ST7735_POWER_PARTIAL) ||
+      ((Mode == ST7735_POWER_PARTIAL) &&
+       (((pObj->Panel.Orientation != ST7735_ORIENTATION_PORTRAIT) &&
+         (pObj->Panel.Orientation != ST7735_ORIENTATION_PORTRAIT_ROT180)) ||
+        (Start > End) || (End >= ST7735_HEIGHT) || (pObj->Panel.ScrollVsa != 0U))))
   {
     ret = ST7735_ERROR;
   }
   else
   {
-    for (i = 0; i < Length; i++)
+    if ((pObj->Panel.PowerMode == ST7735_POWER_IDLE) && (Mode != ST7735_POWER_IDLE))
     {
-      /* Exchange LSB and MSB to fit LCD specification */
-      pdata[2U * i] = (uint8_t)(Color >> 8);
-      pdata[(2U * i) + 1U] = (uint8_t)(Color);
+      ret += st7735_write_reg(&pObj->Ctx, ST7735_IDLE_MODE_OFF, pdata, 0);
+    }
+    if ((pObj->Panel.PowerMode == ST7735_POWER_PARTIAL) && (Mode != ST7735_POWER_PARTIAL))
+    {
+      ret += st7735_write_reg(&pObj->Ctx, ST7735_NORMAL_DISPLAY_OFF, pdata, 0);
     }
-    if (st7735_send_data(&pObj->Ctx, (uint8_t *)&pdata[0], 2U * Length) != ST7735_OK)
+
+    if ((Mode == ST7735_POWER_IDLE) && (pObj->Panel.PowerMode != ST7735_POWER_IDLE))
+    {
+      ret += st7735_write_reg(&pObj->Ctx, ST7735_IDLE_MODE_ON, pdata, 0);
+    }
+    else if (Mode == ST7735_POWER_PARTIAL)
+    {
+      /* Frame memory rows, running backwards when MY is set */
+      if (OrientationTab[pObj->Panel.Orientation] & ST7735_MADCTL_MY)
+      {
+        psl = pObj->Panel.RowStart + ST7735_HEIGHT - 1U - End;
+        pel = pObj->Panel.RowStart + ST7735_HEIGHT - 1U - Start;
+      }
+      else
+      {
+        psl = pObj->Panel.RowStart + Start;
+        pel = pObj->Panel.RowStart + End;
+      }
+      pdata[0] = (uint8_t)(psl >> 8);
+      pdata[1] = (uint8_t)psl;
+      pdata[2] = (uint8_t)(pel >> 8);
+      pdata[3] = (uint8_t)pel;
+      ret += st7735_write_reg(&pObj->Ctx, ST7735_PTLAR, pdata, 4);
+      if (pObj->Panel.PowerMode != ST7735_POWER_PARTIAL)
+      {
+        ret += st7735_write_reg(&pObj->Ctx, ST7735_PARTIAL_DISPLAY_ON, pdata, 0);
+      }
+    }
+
+    if (ret == ST7735_OK)
+    {
+      pObj->Panel.PowerMode = Mode;
+    }
+    else
     {
       ret = ST7735_ERROR;
     }
@@ -805,68 +750,545 @@ int32_t ST7735_DrawHLine(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, ui
 }
 
 /**
- * @brief  Draw vertical line.
+ * @brief  Set the refresh rate of the panel, in all three display modes.
+ * @note   The rate is the closest one the oscillator divider and the porches
+ *         give, from about 31 Hz to 96 Hz. A lower rate costs less current,
+ *         the panel keeps its picture at any rate.
  * @param  pObj Component object
- * @param  Color    Specifies the RGB color
- * @param  Xpos     specifies the X position.
- * @param  Ypos     specifies the Y position.
- * @param  Length   specifies the Line length.
+ * @param  Rate frame rate in Hz
  * @retval The component status
  */
-int32_t ST7735_DrawVLine(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint32_t Length, uint32_t Color)
+int32_t ST7735_SetFrameRate(ST7735_Object_t *pObj, uint32_t Rate)
 {
   int32_t ret = ST7735_OK;
-  uint32_t counter;
+  uint32_t rtna, porch, lines, got, err;
+  uint32_t best_err = 0xFFFFFFFFU, best_rtna = 0U, best_porch = ST7735_PORCH_MIN, best_rate = 0U;
+  uint8_t pdata[6];
 
-  if ((Ypos + Length) > ST7735Ctx.Height)
+  if (Rate == 0U)
   {
     ret = ST7735_ERROR;
   }
   else
   {
-    for (counter = 0; counter < Length; counter++)
+    /* For each divider the porches closest to the rate, split evenly */
+    for (rtna = 0U; rtna <= ST7735_RTNA_MAX; rtna++)
     {
-      if (ST7735_SetPixel(pObj, Xpos, Ypos + counter, Color) != ST7735_OK)
+      lines = ST7735_FOSC_HZ / ((rtna * 2U + 40U) * Rate);
+      porch = (lines > ST7735_HEIGHT) ? ((lines - ST7735_HEIGHT) / 2U) : 0U;
+      porch = (porch < ST7735_PORCH_MIN) ? ST7735_PORCH_MIN : ((porch > ST7735_PORCH_MAX) ? ST7735_PORCH_MAX : porch);
+      got = ST7735_FRAME_RATE(rtna, porch, porch);
+      err = (got > Rate) ? (got - Rate) : (Rate - got);
+      if (err < best_err)
       {
-        ret = ST7735_ERROR;
-        break;
+        best_err = err;
+        best_rtna = rtna;
+        best_porch = porch;
+        best_rate = got;
       }
     }
+
+    pdata[0] = pdata[3] = (uint8_t)best_rtna;
+    pdata[1] = pdata[4] = (uint8_t)best_porch;
+    pdata[2] = pdata[5] = (uint8_t)best_porch;
+    ret += st7735_write_reg(&pObj->Ctx, ST7735_FRAME_RATE_CTRL1, pdata, 3);
+    ret += st7735_write_reg(&pObj->Ctx, ST7735_FRAME_RATE_CTRL2, pdata, 3);
+    ret += st7735_write_reg(&pObj->Ctx, ST7735_FRAME_RATE_CTRL3, pdata, 6);
+    if (ret == ST7735_OK)
+    {
+      pObj->Panel.FrameRate = best_rate;
+    }
+    else
+    {
+      ret = ST7735_ERROR;
+    }
   }
 
   return ret;
 }
 
 /**
- * @brief  Fill rectangle
+ * @brief  Get the refresh rate of the panel.
  * @param  pObj Component object
- * @param  Xpos X position
- * @param  Ypos Y position
- * @param  Width Rectangle width
- * @param  Height Rectangle height
- * @param  Color Draw color
- * @retval Component status
+ * @param  Rate frame rate in Hz, as set rather than as asked for
+ * @retval The component status
  */
-int32_t ST7735_FillRect(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint32_t Width, uint32_t Height, uint32_t Color)
+int32_t ST7735_GetFrameRate(ST7735_Object_t *pObj, uint32_t *Rate)
 {
-  int32_t ret = ST7735_OK;
-  uint32_t i, y_pos = Ypos;
-
-  for (i = 0; i < Height; i++)
-  {
-    if (ST7735_DrawHLine(pObj, Xpos, y_pos, Width, Color) != ST7735_OK)
-    {
-      ret = ST7735_ERROR;
-      break;
-    }
-    y_pos++;
-  }
+  *Rate = pObj->Panel.FrameRate;
 
-  return ret;
+  return ST7735_OK;
 }
 
 /**
- * @brief  Write pixel.
+ * @brief  Get the address window statistics.
+ * @note   Before windows were cached and packed, every window cost 11 bus
+ *         transactions: 11 * Windows - Transfers is what the cache saved.
+ * @param  pObj Component object
+ * @param  Windows   number of ST7735_SetCursor() calls
+ * @param  Transfers bus transactions spent on them
+ * @retval The component status
+ */
+int32_t ST7735_GetWindowStats(ST7735_Object_t *pObj, uint32_t *Windows, uint32_t *Transfers)
+{
+  (void)pObj;
+
+  *Windows = pObj->Panel.Windows;
+  *Transfers = pObj->Panel.WindowTransfers;
+
+  return ST7735_OK;
+}
+
+/**
+ * @brief  Get the glyph cache counters.
+ * @param  pObj   Component object
+ * @param  Hits   characters drawn from the cache
+ * @param  Misses characters that had to be expanded
+ * @retval The component status
+ */
+int32_t ST7735_GetGlyphCacheStats(ST7735_Object_t *pObj, uint32_t *Hits, uint32_t *Misses)
+{
+  (void)pObj;
+
+  *Hits = GlyphCache.Hits;
+  *Misses = GlyphCache.Misses;
+
+  return ST7735_OK;
+}
+
+/**
+ * @brief  Displays an ASCII character.
+ * @param  pObj Component object
+ * @param  Xpos specifies the X position.
+ * @param  Ypos specifies the Y position.
+ * @param  num  Characters displayed.
+ * @param  size Word size.
+ * @param  fColor ForeColor.
+ * @param  bColor Background Color.
+ * @param  mode   display mode.
+ * @retval The component status
+ */
+int32_t ST7735_DrawChar(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint8_t num, uint8_t size, uint32_t fColor, uint32_t bColor, uint8_t mode)
+{
+  int32_t ret;
+
+  if ((num < ' ') || (num > '~') || (NULL == ST7735_GetGlyph(' ', size)))
+  {
+    ret = ST7735_ERROR; // 没有的字库
+  }
+  else if (mode == ST7735_NOTOVERLAY_DISPLAY)
+  {
+    ret = ST7735_BlitGlyphs(pObj, Xpos, Ypos, &num, 1U, size, fColor, bColor);
+  }
+  else
+  {
+    ret = ST7735_OverlayGlyph(pObj, Xpos, Ypos, num, size, fColor);
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Displays string.
+ * @param  pObj Component object
+ * @param  Xpos specifies the X position.
+ * @param  Ypos specifies the Y position.
+ * @param  string  an string.
+ * @param  size Word size.
+ * @param  fColor ForeColor.
+ * @param  bColor Background Color.
+ * @retval The component status
+ */
+int32_t ST7735_DrawString(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint8_t *string, uint8_t size, uint32_t fColor, uint32_t bColor)
+{
+  int32_t ret = ST7735_OK;
+  uint32_t Xstart = Xpos;
+  uint32_t count, x;
+
+  if (NULL == ST7735_GetGlyph(' ', size))
+  {
+    return ST7735_ERROR; // 没有的字库
+  }
+
+  /*没有到字符串尾部*/
+  while (*string != 0)
+  {
+    /*如果这一行不够位置，就下一行 */
+    if (Xpos > (pObj->Panel.Width - size))
+    {
+      Xpos = Xstart;
+      Ypos = Ypos + size;
+    } /*如果到了屏幕底部，就返回，不再输出*/
+    if (Ypos > (pObj->Panel.Height - size))
+    {
+      ret = ST7735_ERROR;
+      break;
+    }
+    /*判断文字是ASCII还是汉字*/
+    if ((*string >= ' ') && (*string <= '~'))
+    { /*非叠加模式显示: 同一行连续的字符一次写完*/
+      count = 1U;
+      x = Xpos + size / 2U;
+      while ((string[count] >= ' ') && (string[count] <= '~') && (x <= (pObj->Panel.Width - size)))
+      {
+        count++;
+        x += size / 2U;
+      }
+      if (ST7735_BlitGlyphs(pObj, Xpos, Ypos, string, count, size, fColor, bColor) != ST7735_OK)
+      {
+        ret = ST7735_ERROR;
+        break;
+      }
+      string += count;
+      Xpos = x;
+    }
+    else if (string[1] == 0) // 不完整的双字节编码
+    {
+      string++;
+    }
+    else // 汉字显示: 字模由 ST7735_GetWideGlyph() 提供, 没有字库时跳过
+    {
+      const uint8_t *bits;
+      uint32_t width;
+
+      if (ST7735_GetWideGlyph(string, size, &bits, &width) == ST7735_OK)
+      {
+        if (ST7735_BlitBits(pObj, Xpos, Ypos, bits, width, size, fColor, bColor) != ST7735_OK)
+        {
+          ret = ST7735_ERROR;
+          break;
+        }
+        Xpos += width; // 下一个要显示的数据在屏幕上的X位置
+      }
+      string += 2; // 下一个要显示的数据在内存中的位置
+    }
+  }
+  return ret;
+}
+
+/**
+ * @brief  Get the bitmap of a double-byte (GBK) character.
+ * @note   Weak default without any wide font, a font provider overrides it.
+ *         Bitmaps are row-major, ceil(Width / 8) bytes per row, most
+ *         significant bit on the left, size rows, and must stay valid until
+ *         the next call.
+ * @param  pCode  the two bytes of the character
+ * @param  size   font height
+ * @param  pBits  glyph bitmap
+ * @param  Width  glyph width in pixels
+ * @retval ST7735_OK when the font has the character
+ */
+__attribute__((weak)) int32_t ST7735_GetWideGlyph(const uint8_t *pCode, uint8_t size, const uint8_t **pBits, uint32_t *Width)
+{
+  (void)pCode;
+  (void)size;
+  (void)pBits;
+  (void)Width;
+
+  return ST7735_ERROR;
+}
+
+/**
+ * @brief  Displays a bitmap picture.
+ * @param  pObj Component object
+ * @param  Xpos Bmp X position in the LCD
+ * @param  Ypos Bmp Y position in the LCD
+ * @param  pBmp Bmp picture address.
+ * @retval The component status
+ */
+int32_t ST7735_DrawBitmap(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint32_t width, uint32_t height, uint8_t *pBmp)
+{
+  int32_t ret = ST7735_OK;
+
+  if ((Xpos + width) > pObj->Panel.Width)
+  {
+    ret = ST7735_ERROR;
+  }
+  else if ((Ypos + height) > pObj->Panel.Height)
+  {
+    ret = ST7735_ERROR;
+  }
+  else
+  { /* Set Cursor */
+    if (ST7735_SetCursor(pObj, Xpos, Ypos, Xpos + width - 1U, Ypos + height - 1U) != ST7735_OK)
+    {
+      ret = ST7735_ERROR;
+    } /* The whole area goes out in one call, the bus layer puts it in panel byte order */
+    else if (st7735_send_pixels(&pObj->Ctx, pBmp, 2U * width * height) != ST7735_OK)
+    {
+      ret = ST7735_ERROR;
+    }
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Displays a bitmap picture without waiting for the pixels to be sent.
+ * @note   The address window is set synchronously, the pixels are streamed from
+ *         the SPI interrupt. pBmp must not be modified until the bus layer
+ *         reports the end of the transfer.
+ * @param  pObj Component object
+ * @param  Xpos Bmp X position in the LCD
+ * @param  Ypos Bmp Y position in the LCD
+ * @param  pBmp Bmp picture address.
+ * @retval The component status
+ */
+int32_t ST7735_DrawBitmapAsync(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint32_t width, uint32_t height, uint8_t *pBmp)
+{
+  int32_t ret = ST7735_OK;
+
+  if (NULL == pObj->IO.SendPixelsAsync)
+  {
+    ret = ST7735_ERROR;
+  }
+  else if (((Xpos + width) > pObj->Panel.Width) || ((Ypos + height) > pObj->Panel.Height))
+  {
+    ret = ST7735_ERROR;
+  } /* Set Cursor */
+  else if (ST7735_SetCursor(pObj, Xpos, Ypos, Xpos + width - 1U, Ypos + height - 1U) != ST7735_OK)
+  {
+    ret = ST7735_ERROR;
+  }
+  else if (st7735_send_pixels_async(&pObj->Ctx, pBmp, 2U * width * height) != ST7735_OK)
+  {
+    ret = ST7735_ERROR;
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Draws a full RGB rectangle
+ * @param  pObj Component object
+ * @param  Xpos   specifies the X position.
+ * @param  Ypos   specifies the Y position.
+ * @param  pData  pointer to RGB data
+ * @param  Width  specifies the rectangle width.
+ * @param  Height Specifies the rectangle height
+ * @retval The component status
+ */
+int32_t ST7735_FillRGBRect(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint8_t *pData, uint32_t Width, uint32_t Height)
+{
+  return ST7735_FillRGBRectStride(pObj, Xpos, Ypos, pData, Width, Height, Width);
+}
+
+/**
+ * @brief  Send the rows of a rectangle cut out of a larger image through the
+ *         pixel path, in the address window already set.
+ * @note   Contiguous rows go out in one call. Otherwise every row is one call,
+ *         the bus layer puts the pixels in panel byte order as for a bitmap.
+ *         With Async the last call streams from the SPI interrupt.
+ * @param  pObj   Component object
+ * @param  pData  pointer to the first pixel of the rectangle
+ * @param  Width  rectangle width
+ * @param  Height rectangle height
+ * @param  Stride source line length in pixels
+ * @param  Async  1: send the last row in the background
+ * @retval The component status
+ */
+static int32_t ST7735_SendRows(ST7735_Object_t *pObj, uint8_t *pData, uint32_t Width, uint32_t Height, uint32_t Stride, uint8_t Async)
+{
+  int32_t ret = ST7735_OK;
+  uint32_t rows = Height, j;
+
+  if (Stride == Width)
+  {
+    Width *= Height;
+    rows = 1U;
+  }
+  for (j = 0; (j + 1U < rows) && (ret == ST7735_OK); j++)
+  {
+    if (st7735_send_pixels(&pObj->Ctx, pData + (2U * j * Stride), 2U * Width) != ST7735_OK)
+    {
+      ret = ST7735_ERROR;
+    }
+  }
+  if (ret == ST7735_OK)
+  {
+    pData += 2U * j * Stride;
+    if (Async)
+    {
+      ret = (st7735_send_pixels_async(&pObj->Ctx, pData, 2U * Width) != ST7735_OK) ? ST7735_ERROR : ST7735_OK;
+    }
+    else
+    {
+      ret = (st7735_send_pixels(&pObj->Ctx, pData, 2U * Width) != ST7735_OK) ? ST7735_ERROR : ST7735_OK;
+    }
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Draws a full RGB rectangle taken from a larger image
+ * @note   The rectangle is sent through one address window, row by row through
+ *         the same pixel path as a bitmap: the pixels are in the bitmap byte
+ *         order and packed into the FIFO straight from pData.
+ * @param  pObj Component object
+ * @param  Xpos   specifies the X position.
+ * @param  Ypos   specifies the Y position.
+ * @param  pData  pointer to the first RGB565 pixel of the rectangle
+ * @param  Width  specifies the rectangle width.
+ * @param  Height Specifies the rectangle height
+ * @param  Stride source line length in pixels, at least Width
+ * @retval The component status
+ */
+int32_t ST7735_FillRGBRectStride(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint8_t *pData, uint32_t Width, uint32_t Height, uint32_t Stride)
+{
+  int32_t ret = ST7735_OK;
+
+  if ((NULL == pData) || (Stride < Width))
+  {
+    ret = ST7735_ERROR;
+  }
+  else if (((Xpos + Width) > pObj->Panel.Width) || ((Ypos + Height) > pObj->Panel.Height))
+  {
+    ret = ST7735_ERROR;
+  }
+  else if (!Width || !Height)
+  {
+    ret = ST7735_OK;
+  } /* Set Cursor */
+  else if (ST7735_SetCursor(pObj, Xpos, Ypos, Xpos + Width - 1U, Ypos + Height - 1U) != ST7735_OK)
+  {
+    ret = ST7735_ERROR;
+  }
+  else
+  {
+    ret = ST7735_SendRows(pObj, pData, Width, Height, Stride, 0U);
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Draws a full RGB rectangle taken from a larger image without waiting
+ *         for the last pixels to be sent.
+ * @note   As ST7735_FillRGBRectStride(), the last row (all of a contiguous
+ *         rectangle) is streamed from the SPI interrupt. pData must not be
+ *         modified until the bus layer reports the end of the transfer.
+ * @param  pObj Component object
+ * @param  Xpos   specifies the X position.
+ * @param  Ypos   specifies the Y position.
+ * @param  pData  pointer to the first RGB565 pixel of the rectangle
+ * @param  Width  specifies the rectangle width, not 0.
+ * @param  Height Specifies the rectangle height, not 0.
+ * @param  Stride source line length in pixels, at least Width
+ * @retval The component status
+ */
+int32_t ST7735_FillRGBRectStrideAsync(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint8_t *pData, uint32_t Width, uint32_t Height, uint32_t Stride)
+{
+  int32_t ret = ST7735_OK;
+
+  if ((NULL == pData) || (NULL == pObj->IO.SendPixelsAsync) || (Stride < Width) || !Width || !Height)
+  {
+    ret = ST7735_ERROR;
+  }
+  else if (((Xpos + Width) > pObj->Panel.Width) || ((Ypos + Height) > pObj->Panel.Height))
+  {
+    ret = ST7735_ERROR;
+  } /* Set Cursor */
+  else if (ST7735_SetCursor(pObj, Xpos, Ypos, Xpos + Width - 1U, Ypos + Height - 1U) != ST7735_OK)
+  {
+    ret = ST7735_ERROR;
+  }
+  else
+  {
+    ret = ST7735_SendRows(pObj, pData, Width, Height, Stride, 1U);
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Draw Horizontal line.
+ * @param  pObj Component object
+ * @param  Xpos   specifies the X position.
+ * @param  Ypos   specifies the Y position.
+ * @param  Length specifies the Line length.
+ * @param  Color  Specifies the RGB color in RGB565 format
+ * @retval The component status
+ */
+int32_t ST7735_DrawHLine(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint32_t Length, uint32_t Color)
+{
+  return ST7735_FillWindow(pObj, Xpos, Ypos, Length, 1U, Color);
+}
+
+/**
+ * @brief  Draw vertical line.
+ * @param  pObj Component object
+ * @param  Color    Specifies the RGB color
+ * @param  Xpos     specifies the X position.
+ * @param  Ypos     specifies the Y position.
+ * @param  Length   specifies the Line length.
+ * @retval The component status
+ */
+int32_t ST7735_DrawVLine(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint32_t Length, uint32_t Color)
+{
+  /* A 1-pixel wide window: the panel wraps to the next row after each pixel */
+  return ST7735_FillWindow(pObj, Xpos, Ypos, 1U, Length, Color);
+}
+
+/**
+ * @brief  Fill rectangle
+ * @param  pObj Component object
+ * @param  Xpos X position
+ * @param  Ypos Y position
+ * @param  Width Rectangle width
+ * @param  Height Rectangle height
+ * @param  Color Draw color
+ * @retval Component status
+ */
+int32_t ST7735_FillRect(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint32_t Width, uint32_t Height, uint32_t Color)
+{
+  return ST7735_FillWindow(pObj, Xpos, Ypos, Width, Height, Color);
+}
+
+/**
+ * @brief  Draw rectangle outline
+ * @param  pObj Component object
+ * @param  Xpos X position
+ * @param  Ypos Y position
+ * @param  Width Rectangle width
+ * @param  Height Rectangle height
+ * @param  Color Draw color
+ * @retval Component status
+ */
+int32_t ST7735_DrawRect(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint32_t Width, uint32_t Height, uint32_t Color)
+{
+  int32_t ret = ST7735_OK;
+
+  if (!Width || !Height)
+  {
+    return ST7735_OK;
+  }
+
+  /* Top and bottom edges, then the sides between them */
+  ret += ST7735_FillWindow(pObj, Xpos, Ypos, Width, 1U, Color);
+  if (Height > 1U)
+  {
+    ret += ST7735_FillWindow(pObj, Xpos, Ypos + Height - 1U, Width, 1U, Color);
+  }
+  if (Height > 2U)
+  {
+    ret += ST7735_FillWindow(pObj, Xpos, Ypos + 1U, 1U, Height - 2U, Color);
+    if (Width > 1U)
+    {
+      ret += ST7735_FillWindow(pObj, Xpos + Width - 1U, Ypos + 1U, 1U, Height - 2U, Color);
+    }
+  }
+
+  if (ret != ST7735_OK)
+  {
+    ret = ST7735_ERROR;
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Write pixel.
  * @param  pObj Component object
  * @param  Xpos specifies the X position.
  * @param  Ypos specifies the Y position.
@@ -882,7 +1304,7 @@ int32_t ST7735_SetPixel(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uin
   color = (uint16_t)((uint16_t)Color << 8);
   color |= (uint16_t)((uint16_t)(Color >> 8));
 
-  if ((Xpos >= ST7735Ctx.Width) || (Ypos >= ST7735Ctx.Height))
+  if ((Xpos >= pObj->Panel.Width) || (Ypos >= pObj->Panel.Height))
   {
     ret = ST7735_ERROR;
   } /* Set Cursor */
@@ -949,7 +1371,7 @@ int32_t ST7735_GetXSize(ST7735_Object_t *pObj, uint32_t *XSize)
 {
   (void)pObj;
 
-  *XSize = ST7735Ctx.Width;
+  *XSize = pObj->Panel.Width;
 
   return ST7735_OK;
 }
@@ -963,7 +1385,7 @@ int32_t ST7735_GetYSize(ST7735_Object_t *pObj, uint32_t *YSize)
 {
   (void)pObj;
 
-  *YSize = ST7735Ctx.Height;
+  *YSize = pObj->Panel.Height;
 
   return ST7735_OK;
 }
@@ -990,23 +1412,427 @@ static int32_t ST7735_SetDisplayWindow(ST7735_Object_t *pObj,
                                        uint32_t Height)
 {
   int32_t ret;
-  uint8_t tmp;
+  uint8_t pdata[4];
+
+  /* The window cached by ST7735_SetCursor() is no longer the panel's */
+  pObj->Panel.ColumnValid = 0U;
+  pObj->Panel.RowValid = 0U;
 
   /* Column addr set, 4 args, no delay: XSTART = Xpos, XEND = (Xpos + Width - 1) */
-  ret = st7735_write_reg(&pObj->Ctx, ST7735_CASET, (uint8_t *)&Xpos, 1);
-  tmp = (uint8_t)Xpos + 2;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  ret += st7735_send_data(&pObj->Ctx, (uint8_t *)&Xpos, 1);
-  tmp = 0x80 + 2;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
+  Xpos += pObj->Panel.XOffset;
+  pdata[0] = (uint8_t)(Xpos >> 8);
+  pdata[1] = (uint8_t)Xpos;
+  pdata[2] = (uint8_t)((Xpos + Width - 1U) >> 8);
+  pdata[3] = (uint8_t)(Xpos + Width - 1U);
+  ret = st7735_write_reg(&pObj->Ctx, ST7735_CASET, pdata, 4);
 
   /* Row addr set, 4 args, no delay: YSTART = Ypos, YEND = (Ypos + Height - 1) */
-  ret += st7735_write_reg(&pObj->Ctx, ST7735_RASET, (uint8_t *)&Ypos, 1);
-  tmp = (uint8_t)Ypos + 3;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
-  ret += st7735_send_data(&pObj->Ctx, (uint8_t *)&Ypos, 1);
-  tmp = 0x80 + 3;
-  ret += st7735_send_data(&pObj->Ctx, &tmp, 1);
+  Ypos += pObj->Panel.YOffset;
+  pdata[0] = (uint8_t)(Ypos >> 8);
+  pdata[1] = (uint8_t)Ypos;
+  pdata[2] = (uint8_t)((Ypos + Height - 1U) >> 8);
+  pdata[3] = (uint8_t)(Ypos + Height - 1U);
+  ret += st7735_write_reg(&pObj->Ctx, ST7735_RASET, pdata, 4);
+
+  if (ret != ST7735_OK)
+  {
+    ret = ST7735_ERROR;
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Fill a rectangle clipped to the display with one window and one burst.
+ * @note   Parts outside the display are dropped, a rectangle that starts
+ *         outside it draws nothing.
+ * @param  pObj   Component object
+ * @param  Xpos   X position
+ * @param  Ypos   Y position
+ * @param  Width  Rectangle width
+ * @param  Height Rectangle height
+ * @param  Color  RGB565 color
+ * @retval Component status
+ */
+static int32_t ST7735_FillWindow(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint32_t Width, uint32_t Height, uint32_t Color)
+{
+  int32_t ret = ST7735_OK;
+  uint8_t pattern[64];
+  uint32_t i, length, chunk;
+
+  /* Clip against the display */
+  if ((Xpos >= pObj->Panel.Width) || (Ypos >= pObj->Panel.Height) || !Width || !Height)
+  {
+    return ST7735_OK;
+  }
+  if (Width > (pObj->Panel.Width - Xpos))
+  {
+    Width = pObj->Panel.Width - Xpos;
+  }
+  if (Height > (pObj->Panel.Height - Ypos))
+  {
+    Height = pObj->Panel.Height - Ypos;
+  }
+
+  /* Exchange LSB and MSB to fit LCD specification */
+  pattern[0] = (uint8_t)(Color >> 8);
+  pattern[1] = (uint8_t)(Color);
+  length = 2U * Width * Height;
+
+  /* One window for the whole rectangle */
+  if (ST7735_SetCursor(pObj, Xpos, Ypos, Xpos + Width - 1U, Ypos + Height - 1U) != ST7735_OK)
+  {
+    ret = ST7735_ERROR;
+  }
+  else if (pObj->IO.FillPixels != NULL)
+  {
+    /* The bus repeats the pixel straight from its FIFO */
+    if (st7735_fill_pixels(&pObj->Ctx, pattern, length) != ST7735_OK)
+    {
+      ret = ST7735_ERROR;
+    }
+  }
+  else
+  {
+    /* Stream the same pattern buffer until the window is full */
+    for (i = 2U; i < sizeof(pattern); i++)
+    {
+      pattern[i] = pattern[i & 1U];
+    }
+    while (length)
+    {
+      chunk = (length > sizeof(pattern)) ? sizeof(pattern) : length;
+      if (st7735_send_data(&pObj->Ctx, pattern, chunk) != ST7735_OK)
+      {
+        ret = ST7735_ERROR;
+        break;
+      }
+      length -= chunk;
+    }
+  }
+
+  return ret;
+}
+
+/**
+ * @brief  Get the bitmap of an ASCII character.
+ * @note   The asc2_* tables are column-major: size / 2 columns of
+ *         ceil(size / 8) bytes, most significant bit on top.
+ * @param  num  character, ' ' to '~'
+ * @param  size font height, 12, 16, 24 or 32
+ * @retval Glyph bitmap, NULL when there is no such font
+ */
+static const uint8_t *ST7735_GetGlyph(uint8_t num, uint8_t size)
+{
+  /*得到偏移后的值（ASCII字库是从空格开始取模，所以-' '就是对应字符的字库）*/
+  num = num - ' ';
+  switch (size)
+  {
+  case 12U:
+    return asc2_1206[num]; // 调用1206字体
+  case 16U:
+    return asc2_1608[num]; // 调用1608字体
+  case 24U:
+    return asc2_2412[num]; // 调用2412字体
+  case 32U:
+    return asc2_3216[num]; // 调用3216字体
+  default:
+    return NULL; // 没有的字库
+  }
+}
+
+/**
+ * @brief  Draw a run of characters on one line through a single window.
+ * @note   Each row of the run is expanded into an RGB565 line buffer in
+ *         panel byte order and sent as one burst. The run is clipped to
+ *         the display.
+ * @param  pObj   Component object
+ * @param  Xpos   X position
+ * @param  Ypos   Y position
+ * @param  pStr   characters, ' ' to '~'
+ * @param  Count  number of characters
+ * @param  size   font height
+ * @param  fColor ForeColor
+ * @param  bColor Background Color
+ * @retval Component status
+ */
+static int32_t ST7735_BlitGlyphs(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, const uint8_t *pStr, uint32_t Count, uint8_t size, uint32_t fColor, uint32_t bColor)
+{
+  uint8_t *line = ST7735_Line;
+  const uint8_t *glyph[(ST7735_LINE_MAX / 6U) + 1U];
+  const uint8_t *cached[(ST7735_LINE_MAX / 6U) + 1U];
+  uint32_t gw = size / 2U;
+  uint32_t bpc = (size + 7U) / 8U;
+  uint32_t width = Count * gw;
+  uint32_t height = size;
+  uint32_t x, y, col, n, cols;
+  uint8_t bits, mask;
+
+  if ((Xpos >= pObj->Panel.Width) || (Ypos >= pObj->Panel.Height) || !Count)
+  {
+    return ST7735_OK;
+  }
+  if (width > (pObj->Panel.Width - Xpos))
+  {
+    width = pObj->Panel.Width - Xpos;
+    Count = (width + gw - 1U) / gw;
+  }
+  if (height > (pObj->Panel.Height - Ypos))
+  {
+    height = pObj->Panel.Height - Ypos;
+  }
+  GlyphCache.Stamp++;
+  for (n = 0; n < Count; n++)
+  {
+    glyph[n] = ST7735_GetGlyph(pStr[n], size);
+    cached[n] = ST7735_CachedGlyph(pStr[n], size, fColor, bColor);
+  }
+
+  if (ST7735_SetCursor(pObj, Xpos, Ypos, Xpos + width - 1U, Ypos + height - 1U) != ST7735_OK)
+  {
+    return ST7735_ERROR;
+  }
+
+  for (y = 0; y < height; y++)
+  {
+    mask = (uint8_t)(0x80U >> (y & 7U));
+    n = 0;
+    col = 0;
+    for (x = 0; x < width; x++)
+    {
+      if ((0U == col) && (cached[n] != NULL))
+      {
+        /* Cached glyph: copy its row and move on to the next glyph */
+        cols = ((width - x) < gw) ? (width - x) : gw;
+        memcpy(&line[2U * x], cached[n] + (2U * gw * y), 2U * cols);
+        x += cols - 1U;
+        n++;
+        continue;
+      }
+      bits = glyph[n][(col * bpc) + (y / 8U)];
+      /* Exchange LSB and MSB to fit LCD specification */
+      if (bits & mask)
+      {
+        line[2U * x] = (uint8_t)(fColor >> 8);
+        line[(2U * x) + 1U] = (uint8_t)fColor;
+      }
+      else
+      {
+        line[2U * x] = (uint8_t)(bColor >> 8);
+        line[(2U * x) + 1U] = (uint8_t)bColor;
+      }
+      if (++col == gw)
+      {
+        col = 0;
+        n++;
+      }
+    }
+    if (st7735_send_data(&pObj->Ctx, line, 2U * width) != ST7735_OK)
+    {
+      return ST7735_ERROR;
+    }
+  }
+
+  return ST7735_OK;
+}
+
+/**
+ * @brief  Expand a glyph to RGB565 rows in panel byte order.
+ * @param  pDst   size / 2 * size pixels
+ * @param  pGlyph glyph bitmap from ST7735_GetGlyph()
+ * @param  size   font height
+ * @param  fColor ForeColor
+ * @param  bColor Background Color
+ * @retval None
+ */
+static void ST7735_ExpandGlyph(uint8_t *pDst, const uint8_t *pGlyph, uint8_t size, uint32_t fColor, uint32_t bColor)
+{
+  uint32_t bpc = (size + 7U) / 8U;
+  uint32_t x, y;
+  uint32_t color;
+
+  for (y = 0; y < size; y++)
+  {
+    for (x = 0; x < (size / 2U); x++)
+    {
+      color = (pGlyph[(x * bpc) + (y / 8U)] & (0x80U >> (y & 7U))) ? fColor : bColor;
+      /* Exchange LSB and MSB to fit LCD specification */
+      *pDst++ = (uint8_t)(color >> 8);
+      *pDst++ = (uint8_t)color;
+    }
+  }
+}
+
+/**
+ * @brief  Look up a glyph in the cache, expanding and inserting it on a miss.
+ * @note   Entries are evicted least recently used first until the new glyph
+ *         fits in ST7735_GLYPH_CACHE_SIZE. Entries used by the current draw
+ *         call are never evicted, their pixels stay valid until it returns.
+ * @param  num    character, ' ' to '~'
+ * @param  size   font height
+ * @param  fColor ForeColor
+ * @param  bColor Background Color
+ * @retval Glyph pixels, NULL when the glyph cannot be cached
+ */
+static const uint8_t *ST7735_CachedGlyph(uint8_t num, uint8_t size, uint32_t fColor, uint32_t bColor)
+{
+  ST7735_Glyph_t *entry, *victim;
+  uint32_t colors = ((fColor & 0xFFFFU) << 16) | (bColor & 0xFFFFU);
+  uint32_t bytes = (uint32_t)size * size;
+  uint32_t i;
+
+  if ((0U == ST7735_GLYPH_CACHE_SIZE) || (bytes > ST7735_GLYPH_CACHE_SIZE))
+  {
+    return NULL;
+  }
+
+  for (i = 0; i < ST7735_GLYPH_CACHE_ENTRIES; i++)
+  {
+    entry = &GlyphCache.Entry[i];
+    if ((entry->pPixels != NULL) && (entry->Char == num) && (entry->Size == size) && (entry->Colors == colors))
+    {
+      entry->Used = GlyphCache.Stamp;
+      GlyphCache.Hits++;
+      return entry->pPixels;
+    }
+  }
+  GlyphCache.Misses++;
+
+  /* Make room: a free entry and enough bytes under the cap */
+  for (;;)
+  {
+    entry = NULL;
+    victim = NULL;
+    for (i = 0; i < ST7735_GLYPH_CACHE_ENTRIES; i++)
+    {
+      if (NULL == GlyphCache.Entry[i].pPixels)
+      {
+        entry = &GlyphCache.Entry[i];
+      }
+      else if ((GlyphCache.Entry[i].Used != GlyphCache.Stamp) &&
+               ((NULL == victim) || ((int32_t)(GlyphCache.Entry[i].Used - victim->Used) < 0)))
+      {
+        victim = &GlyphCache.Entry[i];
+      }
+    }
+    if ((entry != NULL) && ((GlyphCache.Bytes + bytes) <= ST7735_GLYPH_CACHE_SIZE))
+    {
+      break;
+    }
+    if (NULL == victim)
+    {
+      return NULL;
+    }
+    GlyphCache.Bytes -= (uint32_t)victim->Size * victim->Size;
+    free(victim->pPixels);
+    victim->pPixels = NULL;
+  }
+
+  entry->pPixels = malloc(bytes);
+  if (NULL == entry->pPixels)
+  {
+    return NULL;
+  }
+  ST7735_ExpandGlyph(entry->pPixels, ST7735_GetGlyph(num, size), size, fColor, bColor);
+  entry->Colors = colors;
+  entry->Used = GlyphCache.Stamp;
+  entry->Char = num;
+  entry->Size = size;
+  GlyphCache.Bytes += bytes;
+
+  return entry->pPixels;
+}
+
+/**
+ * @brief  Draw a row-major 1-bpp bitmap through one window, clipped to the display.
+ * @param  pObj   Component object
+ * @param  Xpos   X position
+ * @param  Ypos   Y position
+ * @param  pBits  bitmap, ceil(Width / 8) bytes per row, MSB on the left
+ * @param  Width  bitmap width
+ * @param  Height bitmap height
+ * @param  fColor ForeColor
+ * @param  bColor Background Color
+ * @retval Component status
+ */
+static int32_t ST7735_BlitBits(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, const uint8_t *pBits, uint32_t Width, uint32_t Height, uint32_t fColor, uint32_t bColor)
+{
+  uint32_t bpr = (Width + 7U) / 8U;
+  uint32_t x, y, color;
+
+  if ((Xpos >= pObj->Panel.Width) || (Ypos >= pObj->Panel.Height) || !Width || !Height)
+  {
+    return ST7735_OK;
+  }
+  if (Width > (pObj->Panel.Width - Xpos))
+  {
+    Width = pObj->Panel.Width - Xpos;
+  }
+  if (Height > (pObj->Panel.Height - Ypos))
+  {
+    Height = pObj->Panel.Height - Ypos;
+  }
+
+  if (ST7735_SetCursor(pObj, Xpos, Ypos, Xpos + Width - 1U, Ypos + Height - 1U) != ST7735_OK)
+  {
+    return ST7735_ERROR;
+  }
+
+  for (y = 0; y < Height; y++)
+  {
+    for (x = 0; x < Width; x++)
+    {
+      color = (pBits[(y * bpr) + (x / 8U)] & (0x80U >> (x & 7U))) ? fColor : bColor;
+      /* Exchange LSB and MSB to fit LCD specification */
+      ST7735_Line[2U * x] = (uint8_t)(color >> 8);
+      ST7735_Line[(2U * x) + 1U] = (uint8_t)color;
+    }
+    if (st7735_send_data(&pObj->Ctx, ST7735_Line, 2U * Width) != ST7735_OK)
+    {
+      return ST7735_ERROR;
+    }
+  }
+
+  return ST7735_OK;
+}
+
+/**
+ * @brief  Draw the set pixels of a character, leaving the background alone.
+ * @note   Each column of the glyph is split into vertical runs of set pixels,
+ *         every run is one 1-pixel wide window.
+ * @param  pObj   Component object
+ * @param  Xpos   X position
+ * @param  Ypos   Y position
+ * @param  num    character, ' ' to '~'
+ * @param  size   font height
+ * @param  fColor ForeColor
+ * @retval Component status
+ */
+static int32_t ST7735_OverlayGlyph(ST7735_Object_t *pObj, uint32_t Xpos, uint32_t Ypos, uint8_t num, uint8_t size, uint32_t fColor)
+{
+  int32_t ret = ST7735_OK;
+  const uint8_t *glyph = ST7735_GetGlyph(num, size);
+  uint32_t bpc = (size + 7U) / 8U;
+  uint32_t col, y, start;
+  uint8_t set;
+
+  for (col = 0; col < (size / 2U); col++)
+  {
+    start = size;
+    for (y = 0; y <= size; y++)
+    {
+      set = (y < size) && (glyph[(col * bpc) + (y / 8U)] & (0x80U >> (y & 7U))) ? 1U : 0U;
+      if (set && (start == size))
+      {
+        start = y;
+      }
+      else if (!set && (start != size))
+      {
+        ret += ST7735_FillWindow(pObj, Xpos + col, Ypos + start, 1U, y - start, fColor);
+        start = size;
+      }
+    }
+  }
 
   if (ret != ST7735_OK)
   {
@@ -1016,6 +1842,34 @@ static int32_t ST7735_SetDisplayWindow(ST7735_Object_t *pObj,
   return ret;
 }
 
+/**
+ * @brief  Run an init table, see ST7735_InitTab for the format.
+ * @param  pObj   Component object
+ * @param  pTable init table
+ * @retval Component status
+ */
+static int32_t ST7735_SendInitTable(ST7735_Object_t *pObj, const uint8_t *pTable)
+{
+  int32_t ret = ST7735_OK;
+  uint8_t cmds = *pTable++;
+  uint8_t reg, args;
+
+  while (cmds--)
+  {
+    reg = *pTable++;
+    args = *pTable++;
+    /* Command and its arguments, the arguments as one burst */
+    ret += st7735_write_reg(&pObj->Ctx, reg, (uint8_t *)pTable, args & ~ST7735_INIT_DELAY);
+    pTable += args & ~ST7735_INIT_DELAY;
+    if (args & ST7735_INIT_DELAY)
+    {
+      (void)ST7735_IO_Delay(pObj, *pTable++);
+    }
+  }
+
+  return ret;
+}
+
 /**
  * @brief  Wrap component ReadReg to Bus Read function
  * @param  Handle  Component object handle
@@ -1071,6 +1925,46 @@ static int32_t ST7735_RecvDataWrap(void *Handle, uint8_t *pData, uint32_t Length
   return pObj->IO.RecvData(pData, Length);
 }
 
+/**
+ * @brief  Wrap component SendPixels to Bus Write function
+ * @param  handle  Component object handle
+ * @param  pData  The pixels to be written
+ * @retval Component error status
+ */
+static int32_t ST7735_SendPixelsWrap(void *Handle, uint8_t *pData, uint32_t Length)
+{
+  ST7735_Object_t *pObj = (ST7735_Object_t *)Handle;
+
+  return pObj->IO.SendPixels(pData, Length);
+}
+
+/**
+ * @brief  Wrap component SendPixelsAsync to Bus Write function
+ * @param  handle  Component object handle
+ * @param  pData  The pixels to be written
+ * @retval Component error status
+ */
+static int32_t ST7735_SendPixelsAsyncWrap(void *Handle, uint8_t *pData, uint32_t Length)
+{
+  ST7735_Object_t *pObj = (ST7735_Object_t *)Handle;
+
+  return pObj->IO.SendPixelsAsync(pData, Length);
+}
+
+/**
+ * @brief  Wrap component FillPixels to Bus Write function
+ * @param  Handle  Component object handle
+ * @param  pData   The pixel to repeat, in panel byte order
+ * @param  Length  Buffer size
+ * @retval Component error status
+ */
+static int32_t ST7735_FillPixelsWrap(void *Handle, uint8_t *pData, uint32_t Length)
+{
+  ST7735_Object_t *pObj = (ST7735_Object_t *)Handle;
+
+  return pObj->IO.FillPixels(pData, Length);
+}
+
 /**
  * @brief  ST7735 delay
  * @param  Delay  Delay in ms
@@ -85,6 +85,42 @@ int32_t st7735_recv_data(st7735_ctx_t *ctx, uint8_t *pdata, uint32_t length)
   return ctx->RecvData(ctx->handle, pdata, length);
 }
 
+/**
+  * @brief  Send RGB565 pixels in panel byte order
+  * @param  ctx    Component context
+  * @param  pdata  pixels to write
+  * @param  length length of data to write in bytes
+  * @retval Component status
+  */
+int32_t st7735_send_pixels(st7735_ctx_t *ctx, uint8_t *pdata, uint32_t length)
+{
+  return ctx->SendPixels(ctx->handle, pdata, length);
+}
+
+/**
+  * @brief  Start sending RGB565 pixels in the background
+  * @param  ctx    Component context
+  * @param  pdata  pixels to write, must stay valid until the transfer is done
+  * @param  length length of data to write in bytes
+  * @retval Component status
+  */
+int32_t st7735_send_pixels_async(st7735_ctx_t *ctx, uint8_t *pdata, uint32_t length)
+{
+  return ctx->SendPixelsAsync(ctx->handle, pdata, length);
+}
+
+/**
+  * @brief  Send one RGB565 pixel repeatedly
+  * @param  ctx    Component context
+  * @param  pdata  the pixel, 2 bytes already in panel byte order
+  * @param  length length of data to write in bytes
+  * @retval Component status
+  */
+int32_t st7735_fill_pixels(st7735_ctx_t *ctx, uint8_t *pdata, uint32_t length)
+{
+  return ctx->FillPixels(ctx->handle, pdata, length);
+}
+
 /**
   * @}
   */ 
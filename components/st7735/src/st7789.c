@@ -0,0 +1,152 @@
+/**
+ ******************************************************************************
+ * @file    st7789.c
+ * @brief   This file includes the driver for ST7789 LCD panels, 240x240 and
+ *          240x320 IPS glass.
+ ******************************************************************************
+ * @attention
+ *
+ * Everything but the frame rate control is shared with st7735.c: the panel
+ * profile gives the init table, the frame memory size, the offsets and the
+ * MADCTL table, the drawing code goes through the same window cache and
+ * pixel bursts.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "st7789.h"
+
+/** @addtogroup BSP
+ * @{
+ */
+
+/** @addtogroup Components
+ * @{
+ */
+
+/** @addtogroup ST7789
+ * @brief      This file provides a set of functions needed to drive the
+ *             ST7789 LCD.
+ * @{
+ */
+
+/** @defgroup ST7789_Private_Variables Private Variables
+ * @{
+ */
+ST7735_LCD_Drv_t ST7789_LCD_Driver = {
+    .Lcd = {
+        ST7735_Init,
+        ST7735_DeInit,
+        ST7735_ReadID,
+        ST7735_DisplayOn,
+        ST7735_DisplayOff,
+        ST7735_SetBrightness,
+        ST7735_GetBrightness,
+        ST7735_SetOrientation,
+        ST7735_GetOrientation,
+        ST7735_SetCursor,
+        ST7735_DrawBitmap,
+        ST7735_FillRGBRect,
+        ST7735_DrawHLine,
+        ST7735_DrawVLine,
+        ST7735_FillRect,
+        ST7735_GetPixel,
+        ST7735_SetPixel,
+        ST7735_DrawChar,
+        ST7735_DrawString,
+        ST7735_GetXSize,
+        ST7735_GetYSize,
+        ST7735_DrawBitmapAsync,
+        ST7735_FillRGBRectStride,
+        ST7735_DrawRect,
+        ST7735_SetScrollArea,
+        ST7735_SetScrollOffset,
+        ST7735_SetColorCoding,
+        ST7735_SetPowerMode,
+        ST7789_SetFrameRate,
+        ST7735_GetFrameRate,
+        ST7735_Sleep,
+        ST7735_Resume,
+        ST7735_FillRGBRectStrideAsync,
+    },
+};
+
+/* Frame rate = fosc / ((LINE + FPA + BPA) x (250 + RTNA x 16)), RTNA 0..31.
+   The porches stay at the 12 lines PORCTRL of the init table sets, idle and
+   partial modes use the normal mode rate while FRCTRL1.FRSEN is 0 */
+#define ST7789_FOSC_HZ 10000000U
+#define ST7789_LINES 320U
+#define ST7789_PORCH 12U
+#define ST7789_RTNA_MAX 31U
+#define ST7789_FRAME_RATE(rtna) \
+  (ST7789_FOSC_HZ / ((ST7789_LINES + 2U * ST7789_PORCH) * (250U + (rtna) * 16U)))
+/**
+ * @}
+ */
+
+/** @addtogroup ST7789_Exported_Functions
+ * @{
+ */
+/**
+ * @brief  Set the refresh rate of the panel, in all three display modes.
+ * @note   The rate is the closest one the clock divider gives, from about
+ *         39 Hz to 116 Hz.
+ * @param  pObj Component object
+ * @param  Rate frame rate in Hz
+ * @retval The component status
+ */
+int32_t ST7789_SetFrameRate(ST7735_Object_t *pObj, uint32_t Rate)
+{
+  int32_t ret = ST7735_OK;
+  uint32_t rtna, got, err;
+  uint32_t best_err = 0xFFFFFFFFU, best_rtna = 0U;
+  uint8_t tmp;
+
+  if (Rate == 0U)
+  {
+    ret = ST7735_ERROR;
+  }
+  else
+  {
+    for (rtna = 0U; rtna <= ST7789_RTNA_MAX; rtna++)
+    {
+      got = ST7789_FRAME_RATE(rtna);
+      err = (got > Rate) ? (got - Rate) : (Rate - got);
+      if (err < best_err)
+      {
+        best_err = err;
+        best_rtna = rtna;
+      }
+    }
+
+    /* NLA = 0: dot inversion, as after reset */
+    tmp = (uint8_t)best_rtna;
+    if (st7735_write_reg(&pObj->Ctx, ST7789_FRCTRL2, &tmp, 1) != ST7735_OK)
+    {
+      ret = ST7735_ERROR;
+    }
+    else
+    {
+      pObj->Panel.FrameRate = ST7789_FRAME_RATE(best_rtna);
+    }
+  }
+
+  return ret;
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
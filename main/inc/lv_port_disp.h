@@ -25,6 +25,27 @@ extern "C" {
 /**********************
  *      TYPEDEFS
  **********************/
+typedef struct
+{
+    uint32_t frames;       /*Frames refreshed since boot*/
+    uint32_t flushes;      /*flush_cb calls in the last frame*/
+    uint32_t areas;        /*Invalidated areas in the last frame*/
+    uint32_t merged;       /*Areas left after coalescing, each flushed in buffer-sized strips*/
+    uint32_t windows;      /*Address windows set in the last frame*/
+    uint32_t transactions; /*SPI transactions in the last frame*/
+    uint32_t saved;        /*SPI transactions saved by packed and cached windows in the last frame*/
+    uint32_t saved_bytes;  /*Pixel bytes the tile diff did not send in the last frame*/
+    uint32_t total_saved_bytes; /*Pixel bytes the tile diff did not send since boot*/
+} lv_port_disp_stats_t;
+
+typedef struct
+{
+    uint32_t target_fps; /*Refresh rate while the display changes*/
+    uint32_t period_ms;  /*LVGL refresh period now*/
+    uint32_t panel_fps;  /*Panel scan rate now*/
+    uint32_t frames;     /*Frames refreshed since boot*/
+    bool idle;           /*The display is static, at the low rates*/
+} lv_port_disp_rate_t;
 
 /**********************
  * GLOBAL PROTOTYPES
@@ -34,6 +55,23 @@ extern "C" {
  *      MACROS
  **********************/
 void lv_port_disp_init(void);
+lv_disp_t *lv_port_disp_get(uint32_t instance);
+void lv_port_disp_get_stats(uint32_t instance, lv_port_disp_stats_t *stats);
+void lv_port_disp_reset_shadow(void);
+bool lv_port_disp_set_diff(bool enable);
+void lv_port_disp_sleep(void);
+bool lv_port_disp_set_depth(lv_obj_t *scr, uint8_t depth, bool dither);
+bool lv_port_disp_set_idle(uint32_t ms, uint8_t mode, lv_coord_t y1, lv_coord_t y2);
+uint32_t lv_port_disp_get_idle_time(uint32_t instance);
+bool lv_port_disp_set_fps(uint32_t fps);
+void lv_port_disp_get_rate(uint32_t instance, lv_port_disp_rate_t *rate);
+bool lv_port_disp_capture_start(uint32_t instance, uint16_t *buf, uint32_t rows);
+uint32_t lv_port_disp_capture_read(lv_coord_t *y);
+void lv_port_disp_capture_release(void);
+void lv_port_disp_capture_stop(void);
+#if LV_COLOR_DEPTH == 8
+void lv_port_disp_set_palette(const uint16_t *palette);
+#endif
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -0,0 +1,852 @@
+/* Console — LCD commands
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_console.h"
+#include "argtable3/argtable3.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "lvgl.h"
+#include "lcd.h"
+#include "lcd_font.h"
+#include "spi_bus.h"
+#include "esp_timer.h"
+#include "esp_sleep.h"
+#include "lv_port_disp.h"
+#include "cmd_lcd.h"
+
+static const char *TAG = "cmd_lcd";
+
+/* Owned by gui_task, every LCD access from the console must hold it */
+extern SemaphoreHandle_t xGuiSemaphore;
+
+#define LCD_BENCH_ROWS 10U
+#define LCD_BENCH_TEXT_MAX 32U
+
+/* Rows captured per frame, one tile band of the diff: the refresh that carries
+   them costs one strip more than usual */
+#define SCREENSHOT_ROWS 8U
+/* A static display refreshes at DISP_STATIC_FPS, an invalidated band sooner */
+#define SCREENSHOT_BAND_TIMEOUT_MS 1000U
+#define SCREENSHOT_PATH "/littlefs/screen.tga"
+
+static inline uint32_t lcd_get_ccount(void)
+{
+    uint32_t ccount;
+
+    __asm__ __volatile__("rsr %0, ccount" : "=a"(ccount));
+    return ccount;
+}
+
+/* Full screen in LCD_BENCH_ROWS strips, the same shape as an LVGL flush */
+static uint32_t bench_bitmap(uint32_t xsize, uint32_t ysize, uint16_t *strip)
+{
+    for (uint32_t y = 0; y < ysize; y += LCD_BENCH_ROWS) {
+        uint32_t rows = (ysize - y < LCD_BENCH_ROWS) ? ysize - y : LCD_BENCH_ROWS;
+        LCD_DrawBitmap(LCD_NUMBER, 0, y, xsize, rows, (uint8_t *)strip);
+    }
+    return xsize * ysize;
+}
+
+/* Same strips as 8-bit RGB332, half the source bytes, expanded through a table */
+static uint32_t bench_bitmap8(uint32_t xsize, uint32_t ysize, uint16_t *strip)
+{
+    static uint16_t lut[256];
+
+    LCD_MakeLutRGB332(lut);
+    LCD_SetLut(LCD_NUMBER, lut);
+    for (uint32_t y = 0; y < ysize; y += LCD_BENCH_ROWS) {
+        uint32_t rows = (ysize - y < LCD_BENCH_ROWS) ? ysize - y : LCD_BENCH_ROWS;
+        LCD_DrawBitmap(LCD_NUMBER, 0, y, xsize, rows, (uint8_t *)strip);
+    }
+    LCD_SetLut(LCD_NUMBER, NULL);
+    return xsize * ysize;
+}
+
+/* Same strips through the generic RGB565 blit, staged in panel byte order */
+static uint32_t bench_rgbrect(uint32_t xsize, uint32_t ysize, uint16_t *strip)
+{
+    for (uint32_t y = 0; y < ysize; y += LCD_BENCH_ROWS) {
+        uint32_t rows = (ysize - y < LCD_BENCH_ROWS) ? ysize - y : LCD_BENCH_ROWS;
+        LCD_FillRGBRect(LCD_NUMBER, 0, y, (uint8_t *)strip, xsize, rows);
+    }
+    return xsize * ysize;
+}
+
+/* One call per pixel: the cost of a per-pixel function call path */
+static uint32_t bench_pixel(uint32_t xsize, uint32_t ysize, uint16_t *strip)
+{
+    for (uint32_t y = 0; y < ysize; y++) {
+        for (uint32_t x = 0; x < xsize; x++) {
+            LCD_WritePixel(LCD_NUMBER, x, y, strip[x]);
+        }
+    }
+    return xsize * ysize;
+}
+
+/* Full screen solid fill in one window, how LCD_Init clears the panel */
+static uint32_t bench_clear(uint32_t xsize, uint32_t ysize, uint16_t *strip)
+{
+    LCD_FillRect(LCD_NUMBER, 0, 0, xsize, ysize, strip[0]);
+    return xsize * ysize;
+}
+
+/* Full screen solid fill one line at a time, a window per row */
+static uint32_t bench_clear_rows(uint32_t xsize, uint32_t ysize, uint16_t *strip)
+{
+    for (uint32_t y = 0; y < ysize; y++) {
+        LCD_DrawHLine(LCD_NUMBER, 0, y, xsize, strip[0]);
+    }
+    return xsize * ysize;
+}
+
+/* Full screen in vertical lines, one 1-pixel wide window per column */
+static uint32_t bench_vlines(uint32_t xsize, uint32_t ysize, uint16_t *strip)
+{
+    for (uint32_t x = 0; x < xsize; x++) {
+        LCD_DrawVLine(LCD_NUMBER, x, 0, ysize, strip[x]);
+    }
+    return xsize * ysize;
+}
+
+/* Full screen of 8x16 text, one line per LCD_DrawString() call */
+static uint32_t bench_text(uint32_t xsize, uint32_t ysize, uint16_t *strip)
+{
+    char line[LCD_BENCH_TEXT_MAX + 1];
+    uint32_t chars = xsize / 8U;
+    uint32_t y;
+
+    if (chars > LCD_BENCH_TEXT_MAX) {
+        chars = LCD_BENCH_TEXT_MAX;
+    }
+    for (y = 0; y + 16U <= ysize; y += 16U) {
+        for (uint32_t i = 0; i < chars; i++) {
+            line[i] = (char)('0' + (y / 16U + i) % 43U);
+        }
+        line[chars] = '\0';
+        LCD_DrawString(LCD_NUMBER, 0, y, (uint8_t *)line, 16U, strip[0], ~strip[0]);
+    }
+    return chars * 8U * y;
+}
+
+/* Full screen moved up a text line at a time by the panel, only the exposed
+   line is cleared and redrawn. Counts the pixels that moved, 0 in landscape */
+static uint32_t bench_scroll(uint32_t xsize, uint32_t ysize, uint16_t *strip)
+{
+    uint32_t y, steps = ysize / 16U;
+
+    if (LCD_ScrollSetArea(LCD_NUMBER, 0, 0) != BSP_ERROR_NONE) {
+        return 0;
+    }
+    for (uint32_t i = 0; i < steps; i++) {
+        LCD_ScrollLines(LCD_NUMBER, 16U, ~strip[0]);
+        LCD_ScrollGetLine(LCD_NUMBER, ysize - 16U, &y);
+        LCD_DrawString(LCD_NUMBER, 0, y, (uint8_t *)"scroll", 16U, strip[0], ~strip[0]);
+    }
+    LCD_ScrollSetOffset(LCD_NUMBER, 0);
+    return xsize * ysize * steps;
+}
+
+typedef struct {
+    const char *name;
+    uint32_t (*run)(uint32_t xsize, uint32_t ysize, uint16_t *strip);
+} lcd_bench_t;
+
+static const lcd_bench_t lcd_benches[] = {
+    { "bitmap", bench_bitmap },
+    { "bitmap8", bench_bitmap8 },
+    { "rgbrect", bench_rgbrect },
+    { "pixel", bench_pixel },
+    { "clear", bench_clear },
+    { "clear_rows", bench_clear_rows },
+    { "vlines", bench_vlines },
+    { "text", bench_text },
+    { "scroll", bench_scroll },
+};
+
+/** Arguments used by 'lcd_bench' function */
+static struct {
+    struct arg_str *name;
+    struct arg_end *end;
+} bench_args;
+
+static int lcd_bench(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &bench_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, bench_args.end, argv[0]);
+        return 1;
+    }
+
+    const char *name = bench_args.name->count ? bench_args.name->sval[0] : NULL;
+    uint32_t xsize = 0, ysize = 0;
+    LCD_GetXSize(LCD_NUMBER, &xsize);
+    LCD_GetYSize(LCD_NUMBER, &ysize);
+
+    uint16_t *strip = malloc(xsize * LCD_BENCH_ROWS * sizeof(uint16_t));
+    if (strip == NULL) {
+        ESP_LOGE(TAG, "no memory for a %u-row strip", LCD_BENCH_ROWS);
+        return 1;
+    }
+    for (uint32_t i = 0; i < xsize * LCD_BENCH_ROWS; i++) {
+        strip[i] = (uint16_t)(i * 0x0841U);
+    }
+
+    xSemaphoreTake(xGuiSemaphore, portMAX_DELAY);
+    /* An 8-bit LVGL build keeps a table set, the benchmarks draw RGB565 */
+    const uint16_t *lut = NULL;
+    LCD_GetLut(LCD_NUMBER, &lut);
+    LCD_SetLut(LCD_NUMBER, NULL);
+    /* Per-pixel figures compare controllers, the frame time is what a full
+       repaint of this panel costs at that rate */
+    printf("%s %ux%u, %u px/frame\n", LCD_PANEL_NAME, xsize, ysize, xsize * ysize);
+    for (size_t i = 0; i < sizeof(lcd_benches) / sizeof(lcd_benches[0]); i++) {
+        const lcd_bench_t *b = &lcd_benches[i];
+        if (name && strcmp(name, b->name) != 0) {
+            continue;
+        }
+        int64_t start_us = esp_timer_get_time();
+        uint32_t start = lcd_get_ccount();
+        uint32_t pixels = b->run(xsize, ysize, strip);
+        uint32_t cycles = lcd_get_ccount() - start;
+        uint32_t us = (uint32_t)(esp_timer_get_time() - start_us);
+        if (pixels == 0) {
+            printf("%-10s not supported\n", b->name);
+            continue;
+        }
+        uint32_t frame_us = (uint32_t)((uint64_t)us * xsize * ysize / pixels);
+        printf("%-10s %6u px %10u cycles %6u.%02u cycles/px %6u.%u ms/frame\n", b->name, pixels, cycles,
+               cycles / pixels, (cycles % pixels) * 100U / pixels, frame_us / 1000U, frame_us % 1000U / 100U);
+    }
+    LCD_SetLut(LCD_NUMBER, lut);
+    /* Let LVGL repaint what the benchmark drew over */
+    lv_port_disp_reset_shadow();
+    lv_obj_invalidate(lv_scr_act());
+    xSemaphoreGive(xGuiSemaphore);
+
+    free(strip);
+    return 0;
+}
+
+static void register_lcd_bench()
+{
+    bench_args.name = arg_str0(NULL, NULL, "<name>", "Benchmark to run, all when omitted");
+    bench_args.end = arg_end(1);
+
+    const esp_console_cmd_t cmd = {
+        .command = "lcd_bench",
+        .help = "Measure LCD drawing cost in CPU cycles per pixel",
+        .hint = NULL,
+        .func = &lcd_bench,
+        .argtable = &bench_args
+    };
+    ESP_ERROR_CHECK( esp_console_cmd_register(&cmd) );
+}
+
+/* Repaint the whole screen through LVGL and print what the frame cost */
+static void lcd_stats_frame(const char *name, lv_disp_t *disp, uint32_t instance)
+{
+    lv_port_disp_stats_t stats;
+    LCD_Stats_t before, after;
+
+    lv_obj_invalidate(lv_disp_get_scr_act(disp));
+    LCD_GetStats(instance, &before);
+    int64_t start_us = esp_timer_get_time();
+    uint32_t start = lcd_get_ccount();
+    lv_refr_now(disp);
+    /* The last strip is still streamed from the SPI interrupt */
+    while (disp->driver->draw_buf->flushing) {
+    }
+    uint32_t cycles = lcd_get_ccount() - start;
+    uint32_t us = (uint32_t)(esp_timer_get_time() - start_us);
+    LCD_GetStats(instance, &after);
+    lv_port_disp_get_stats(instance, &stats);
+    printf("%-10s %4u.%u ms %10u cycles %6u transactions %6u bytes saved\n", name, us / 1000U,
+           us % 1000U / 100U, cycles, after.Transactions - before.Transactions, stats.saved_bytes);
+}
+
+/* Cost of the same frame with the tile diff off, on with nothing known about the
+   panel (every tile hashed and sent) and on with the panel already showing it */
+static int lcd_stats_diff(void)
+{
+    lv_disp_t *disp = lv_port_disp_get(LCD_NUMBER);
+
+    if (disp == NULL) {
+        ESP_LOGE(TAG, "no display lcd%u", LCD_NUMBER);
+        return 1;
+    }
+    xSemaphoreTake(xGuiSemaphore, portMAX_DELAY);
+    if (!lv_port_disp_set_diff(true)) {
+        xSemaphoreGive(xGuiSemaphore);
+        printf("tile diff not built in\n");
+        return 1;
+    }
+    printf("lcd%u full screen refresh, %dx%d\n", LCD_NUMBER, lv_disp_get_hor_res(disp), lv_disp_get_ver_res(disp));
+    lv_port_disp_set_diff(false);
+    lcd_stats_frame("diff off", disp, LCD_NUMBER);
+    lv_port_disp_set_diff(true);
+    lcd_stats_frame("diff cold", disp, LCD_NUMBER);
+    lcd_stats_frame("diff same", disp, LCD_NUMBER);
+    xSemaphoreGive(xGuiSemaphore);
+    return 0;
+}
+
+/** Arguments used by 'lcd_stats' function */
+static struct {
+    struct arg_lit *diff;
+    struct arg_end *end;
+} stats_args;
+
+/* 'lcd_stats' command prints the bus cost of the last LVGL frame of every display */
+static int lcd_stats(int argc, char **argv)
+{
+    lv_port_disp_stats_t stats;
+    LCD_Stats_t total;
+
+    int nerrors = arg_parse(argc, argv, (void **) &stats_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, stats_args.end, argv[0]);
+        return 1;
+    }
+    if (stats_args.diff->count) {
+        return lcd_stats_diff();
+    }
+
+    for (uint32_t i = 0; i < LCD_INSTANCES_NBR; i++) {
+        lv_port_disp_get_stats(i, &stats);
+        LCD_GetStats(i, &total);
+        printf("lcd%u frames: %u\n", i, stats.frames);
+        printf("last frame: %u areas invalidated, %u after coalescing\n", stats.areas, stats.merged);
+        printf("tile diff: %u bytes saved in the last frame, %u since boot\n",
+               stats.saved_bytes, stats.total_saved_bytes);
+        printf("last frame: %u flushes, %u windows, %u transactions, %u saved by window packing/cache\n",
+               stats.flushes, stats.windows, stats.transactions, stats.saved);
+        printf("total: %u transactions, %u windows in %u transactions\n",
+               total.Transactions, total.Windows, total.WindowTransactions);
+    }
+    /* One glyph cache serves every panel */
+    LCD_GetStats(LCD_NUMBER, &total);
+    printf("glyph cache (all displays): %u hits, %u misses\n", total.GlyphHits, total.GlyphMisses);
+    return 0;
+}
+
+static void register_lcd_stats()
+{
+    stats_args.diff = arg_lit0("d", "diff", "Time a full screen refresh with the tile diff off and on");
+    stats_args.end = arg_end(1);
+
+    const esp_console_cmd_t cmd = {
+        .command = "lcd_stats",
+        .help = "Print LCD bus statistics of the last LVGL frame",
+        .hint = NULL,
+        .func = &lcd_stats,
+        .argtable = &stats_args
+    };
+    ESP_ERROR_CHECK( esp_console_cmd_register(&cmd) );
+}
+
+/* 'lcd_font' command: lookup cost of the GBK font, cold and warm page cache */
+static int lcd_font(int argc, char **argv)
+{
+    /* "中文显示测试" in GBK */
+    static const uint8_t text[] = { 0xD6, 0xD0, 0xCE, 0xC4, 0xCF, 0xD4, 0xCA, 0xBE, 0xB2, 0xE2, 0xCA, 0xD4, 0x00 };
+    static const char *pass[] = { "cold", "warm" };
+    LCD_FontStats_t before, after;
+
+    xSemaphoreTake(xGuiSemaphore, portMAX_DELAY);
+    LCD_FontFlush();
+    for (int i = 0; i < 2; i++) {
+        LCD_FontGetStats(&before);
+        LCD_DrawString(LCD_NUMBER, 0, 16U * i, (uint8_t *)text, 16U, 0x0000U, 0xFFFFU);
+        LCD_FontGetStats(&after);
+        uint32_t lookups = after.Lookups - before.Lookups;
+        if (lookups == 0 || after.Found == before.Found) {
+            printf("no glyph found, is %s on the partition?\n", LCD_FONT_PATH);
+            break;
+        }
+        printf("%s: %u lookups, %u page reads, %u cycles/lookup\n", pass[i], lookups,
+               after.PageMisses - before.PageMisses, (after.Cycles - before.Cycles) / lookups);
+    }
+    lv_port_disp_reset_shadow();
+    lv_obj_invalidate(lv_scr_act());
+    xSemaphoreGive(xGuiSemaphore);
+    return 0;
+}
+
+static void register_lcd_font()
+{
+    const esp_console_cmd_t cmd = {
+        .command = "lcd_font",
+        .help = "Draw a GBK test string twice and print the font lookup cost",
+        .hint = NULL,
+        .func = &lcd_font,
+    };
+    ESP_ERROR_CHECK( esp_console_cmd_register(&cmd) );
+}
+
+/** Arguments used by 'lcd_depth' function */
+static struct {
+    struct arg_int *bits;
+    struct arg_lit *dither;
+    struct arg_end *end;
+} depth_args;
+
+/* 'lcd_depth' command sets the bus colour depth of the active screen */
+static int lcd_depth(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &depth_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, depth_args.end, argv[0]);
+        return 1;
+    }
+
+    xSemaphoreTake(xGuiSemaphore, portMAX_DELAY);
+    bool ok = lv_port_disp_set_depth(lv_scr_act(), (uint8_t)depth_args.bits->ival[0],
+                                     depth_args.dither->count > 0);
+    /* Redraw so the dithering shows, the depth is switched before the refresh */
+    lv_port_disp_reset_shadow();
+    lv_obj_invalidate(lv_scr_act());
+    xSemaphoreGive(xGuiSemaphore);
+
+    if (!ok) {
+        ESP_LOGE(TAG, "depth must be 0 (default), 12 or 16");
+        return 1;
+    }
+    return 0;
+}
+
+static void register_lcd_depth()
+{
+    depth_args.bits = arg_int1(NULL, NULL, "<0|12|16>", "Bits per pixel on the bus, 0 for the default");
+    depth_args.dither = arg_lit0("d", "dither", "Ordered dithering, 12 bits only");
+    depth_args.end = arg_end(2);
+
+    const esp_console_cmd_t cmd = {
+        .command = "lcd_depth",
+        .help = "Set the LCD bus colour depth of the active screen",
+        .hint = NULL,
+        .func = &lcd_depth,
+        .argtable = &depth_args
+    };
+    ESP_ERROR_CHECK( esp_console_cmd_register(&cmd) );
+}
+
+/** Arguments used by 'lcd_idle' function */
+static struct {
+    struct arg_int *ms;
+    struct arg_str *mode;
+    struct arg_int *y1;
+    struct arg_int *y2;
+    struct arg_end *end;
+} idle_args;
+
+/* 'lcd_idle' command sets what a static display falls back to */
+static int lcd_idle(int argc, char **argv)
+{
+    static const char *modes[] = {"normal", "idle", "partial"};
+    uint8_t mode = LCD_POWER_MODE_NORMAL;
+
+    int nerrors = arg_parse(argc, argv, (void **) &idle_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, idle_args.end, argv[0]);
+        return 1;
+    }
+
+    if (idle_args.ms->count == 0) {
+        for (uint32_t i = 0; i < LCD_INSTANCES_NBR; i++) {
+            printf("lcd%u: %u ms in idle mode\n", i, lv_port_disp_get_idle_time(i));
+        }
+        return 0;
+    }
+    if (idle_args.mode->count) {
+        while (mode <= LCD_POWER_MODE_PARTIAL && strcmp(idle_args.mode->sval[0], modes[mode]) != 0) {
+            mode++;
+        }
+    }
+
+    xSemaphoreTake(xGuiSemaphore, portMAX_DELAY);
+    bool ok = lv_port_disp_set_idle((uint32_t)idle_args.ms->ival[0], mode,
+                                    idle_args.y1->count ? idle_args.y1->ival[0] : 0,
+                                    idle_args.y2->count ? idle_args.y2->ival[0] : 0);
+    xSemaphoreGive(xGuiSemaphore);
+
+    if (!ok) {
+        ESP_LOGE(TAG, "mode must be normal, idle or partial with 0 <= y1 <= y2 < height");
+        return 1;
+    }
+    return 0;
+}
+
+static void register_lcd_idle()
+{
+    idle_args.ms = arg_int0(NULL, NULL, "<ms>", "Time without changes before the idle mode, 0: never");
+    idle_args.mode = arg_str0(NULL, NULL, "<normal|idle|partial>", "Full mode kept, 8 colours, or only lines y1..y2 lit");
+    idle_args.y1 = arg_int0(NULL, NULL, "<y1>", "First line kept lit in partial mode");
+    idle_args.y2 = arg_int0(NULL, NULL, "<y2>", "Last line kept lit in partial mode");
+    idle_args.end = arg_end(4);
+
+    const esp_console_cmd_t cmd = {
+        .command = "lcd_idle",
+        .help = "Set the panel mode of a static display, or print the time spent in it",
+        .hint = NULL,
+        .func = &lcd_idle,
+        .argtable = &idle_args
+    };
+    ESP_ERROR_CHECK( esp_console_cmd_register(&cmd) );
+}
+
+/** Arguments used by 'lcd_fps' function */
+static struct {
+    struct arg_int *fps;
+    struct arg_end *end;
+} fps_args;
+
+/* 'lcd_fps' command sets the target refresh rate and prints the rates since the last call */
+static int lcd_fps(int argc, char **argv)
+{
+    static uint32_t last_frames[LCD_INSTANCES_NBR];
+    static int64_t last_us;
+    int64_t now_us = esp_timer_get_time();
+    uint32_t elapsed_ms = (uint32_t)((now_us - last_us) / 1000);
+    lv_port_disp_rate_t rate;
+    bool ok = true;
+
+    int nerrors = arg_parse(argc, argv, (void **) &fps_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, fps_args.end, argv[0]);
+        return 1;
+    }
+
+    xSemaphoreTake(xGuiSemaphore, portMAX_DELAY);
+    if (fps_args.fps->count) {
+        ok = lv_port_disp_set_fps((uint32_t)fps_args.fps->ival[0]);
+    }
+    printf("%-5s %6s %7s %6s %6s %s\n", "lcd", "target", "period", "panel", "fps", "state");
+    for (uint32_t i = 0; i < LCD_INSTANCES_NBR; i++) {
+        lv_port_disp_get_rate(i, &rate);
+        printf("lcd%-2u %6u %5ums %4uHz %6u %s\n", i, rate.target_fps, rate.period_ms, rate.panel_fps,
+               elapsed_ms ? (rate.frames - last_frames[i]) * 1000U / elapsed_ms : 0, rate.idle ? "static" : "active");
+        last_frames[i] = rate.frames;
+    }
+    xSemaphoreGive(xGuiSemaphore);
+    last_us = now_us;
+
+    if (!ok) {
+        ESP_LOGE(TAG, "fps must be 1 .. 100");
+        return 1;
+    }
+    return 0;
+}
+
+static void register_lcd_fps()
+{
+    fps_args.fps = arg_int0(NULL, NULL, "<fps>", "Refresh rate while the display changes");
+    fps_args.end = arg_end(1);
+
+    const esp_console_cmd_t cmd = {
+        .command = "lcd_fps",
+        .help = "Set the target LVGL refresh rate, print the LVGL and panel rates",
+        .hint = NULL,
+        .func = &lcd_fps,
+        .argtable = &fps_args
+    };
+    ESP_ERROR_CHECK( esp_console_cmd_register(&cmd) );
+}
+
+/** Arguments used by 'lcd_sleep' function */
+static struct {
+    struct arg_int *ms;
+    struct arg_end *end;
+} sleep_args;
+
+/* 'lcd_sleep' command: deep sleep with the panels keeping their picture */
+static int lcd_sleep(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &sleep_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, sleep_args.end, argv[0]);
+        return 1;
+    }
+
+    /* The GUI stays locked: nothing may draw once the panels sleep */
+    xSemaphoreTake(xGuiSemaphore, portMAX_DELAY);
+    lv_port_disp_sleep();
+    SPI_LCD_BL(GPIO_PIN_RESET);
+    ESP_LOGI(TAG, "deep sleep for %d ms", sleep_args.ms->ival[0]);
+    esp_deep_sleep((uint64_t)sleep_args.ms->ival[0] * 1000U);
+    return 0;
+}
+
+static void register_lcd_sleep()
+{
+    sleep_args.ms = arg_int1(NULL, NULL, "<ms>", "Time to sleep, GPIO16 must be wired to RST");
+    sleep_args.end = arg_end(1);
+
+    const esp_console_cmd_t cmd = {
+        .command = "lcd_sleep",
+        .help = "Deep sleep, the panels keep their picture and resume without init",
+        .hint = NULL,
+        .func = &lcd_sleep,
+        .argtable = &sleep_args
+    };
+    ESP_ERROR_CHECK( esp_console_cmd_register(&cmd) );
+}
+
+/* 24-bit pixel in TGA order, blue first, the RGB565 low bits replicated */
+static uint8_t *tga_put_pixel(uint8_t *p, uint16_t c)
+{
+    uint8_t r = (c >> 11) & 0x1FU, g = (c >> 5) & 0x3FU, b = c & 0x1FU;
+
+    *p++ = (uint8_t)((b << 3) | (b >> 2));
+    *p++ = (uint8_t)((g << 2) | (g >> 4));
+    *p++ = (uint8_t)((r << 3) | (r >> 2));
+    return p;
+}
+
+/* One row as TGA RLE packets, never crossing the row: runs of 2 or more pixels
+   as run packets, the rest as raw packets. At most 4 bytes per pixel */
+static uint32_t tga_rle_row(const uint16_t *px, uint32_t width, uint8_t *out)
+{
+    uint8_t *p = out;
+    uint32_t i = 0, n;
+
+    while (i < width) {
+        for (n = 1; i + n < width && n < 128U && px[i + n] == px[i]; n++) {
+        }
+        if (n > 1) {
+            *p++ = (uint8_t)(0x80U | (n - 1U));
+            p = tga_put_pixel(p, px[i]);
+        } else {
+            /* Stop the raw packet where a run starts */
+            for (n = 1; i + n < width && n < 128U && !(i + n + 1U < width && px[i + n] == px[i + n + 1U]); n++) {
+            }
+            *p++ = (uint8_t)(n - 1U);
+            for (uint32_t k = 0; k < n; k++) {
+                p = tga_put_pixel(p, px[i + k]);
+            }
+        }
+        i += n;
+    }
+    return (uint32_t)(p - out);
+}
+
+/* Print a file as hex lines, `xxd -r -p` turns the log back into the file */
+static void screenshot_print(const char *path)
+{
+    uint8_t chunk[32];
+    size_t len;
+    FILE *f = fopen(path, "rb");
+
+    if (f == NULL) {
+        return;
+    }
+    while ((len = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        for (size_t i = 0; i < len; i++) {
+            printf("%02x", chunk[i]);
+        }
+        printf("\n");
+    }
+    fclose(f);
+}
+
+/* Capture a display into an open file as an RLE-compressed TGA. The rows come
+   band by band from the LVGL flushes and are encoded and written here, in the
+   console task: the GUI lock is only held to start and stop the capture.
+   Returns the bytes written, 0 on failure */
+static uint32_t screenshot_capture(FILE *f, uint32_t instance, lv_coord_t width, lv_coord_t height,
+                                   uint16_t *rows, uint8_t *out)
+{
+    static const uint8_t footer[26] = { 0, 0, 0, 0, 0, 0, 0, 0, 'T', 'R', 'U', 'E', 'V', 'I', 'S', 'I', 'O', 'N',
+                                        '-', 'X', 'F', 'I', 'L', 'E', '.', 0 };
+    uint8_t header[18] = { 0 };
+    uint32_t written = 0;
+    lv_coord_t done = 0, y;
+
+    /* Run-length encoded true colour, 24 bits, origin at the top left */
+    header[2] = 10;
+    header[12] = (uint8_t)width;
+    header[13] = (uint8_t)(width >> 8);
+    header[14] = (uint8_t)height;
+    header[15] = (uint8_t)(height >> 8);
+    header[16] = 24;
+    header[17] = 0x20;
+    written += fwrite(header, 1, sizeof(header), f);
+
+    xSemaphoreTake(xGuiSemaphore, portMAX_DELAY);
+    bool started = lv_port_disp_capture_start(instance, rows, SCREENSHOT_ROWS);
+    xSemaphoreGive(xGuiSemaphore);
+    if (!started) {
+        ESP_LOGE(TAG, "a capture is running already");
+        return 0;
+    }
+
+    int64_t band_us = esp_timer_get_time();
+    while (done < height) {
+        uint32_t n = lv_port_disp_capture_read(&y);
+        if (n == 0) {
+            if (esp_timer_get_time() - band_us > SCREENSHOT_BAND_TIMEOUT_MS * 1000LL) {
+                ESP_LOGE(TAG, "row %d not refreshed, is the GUI running?", done);
+                break;
+            }
+            vTaskDelay(1);
+            continue;
+        }
+        for (uint32_t r = 0; r < n; r++) {
+            uint32_t len = tga_rle_row(rows + r * width, width, out);
+            written += fwrite(out, 1, len, f);
+        }
+        done = y + (lv_coord_t)n;
+        lv_port_disp_capture_release();
+        band_us = esp_timer_get_time();
+    }
+
+    xSemaphoreTake(xGuiSemaphore, portMAX_DELAY);
+    lv_port_disp_capture_stop();
+    xSemaphoreGive(xGuiSemaphore);
+
+    written += fwrite(footer, 1, sizeof(footer), f);
+    return (done == height && ferror(f) == 0) ? written : 0;
+}
+
+/** Arguments used by 'screenshot' function */
+static struct {
+    struct arg_str *path;
+    struct arg_int *lcd;
+    struct arg_lit *print;
+    struct arg_end *end;
+} screenshot_args;
+
+/* 'screenshot' command: what a display shows, saved on the littlefs partition */
+static int screenshot(int argc, char **argv)
+{
+    uint32_t instance = LCD_NUMBER, written = 0;
+    FILE *f;
+
+    int nerrors = arg_parse(argc, argv, (void **) &screenshot_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, screenshot_args.end, argv[0]);
+        return 1;
+    }
+
+    const char *path = screenshot_args.path->count ? screenshot_args.path->sval[0] : SCREENSHOT_PATH;
+    if (screenshot_args.lcd->count) {
+        instance = (uint32_t)screenshot_args.lcd->ival[0];
+    }
+    lv_disp_t *disp = lv_port_disp_get(instance);
+    if (disp == NULL) {
+        ESP_LOGE(TAG, "no display lcd%u", instance);
+        return 1;
+    }
+    lv_coord_t width = lv_disp_get_hor_res(disp);
+    lv_coord_t height = lv_disp_get_ver_res(disp);
+
+    /* A band of RGB565 rows and one encoded row, never the whole frame */
+    uint16_t *rows = malloc(width * SCREENSHOT_ROWS * sizeof(uint16_t));
+    uint8_t *out = malloc(width * 4U);
+    int64_t start_us = esp_timer_get_time();
+    if (rows == NULL || out == NULL) {
+        ESP_LOGE(TAG, "no memory for %u rows", SCREENSHOT_ROWS);
+    } else if ((f = fopen(path, "wb")) == NULL) {
+        ESP_LOGE(TAG, "cannot create %s", path);
+    } else {
+        written = screenshot_capture(f, instance, width, height, rows, out);
+        if (fclose(f) != 0) {
+            written = 0;
+        }
+        if (written == 0) {
+            remove(path);
+        }
+    }
+    free(out);
+    free(rows);
+    if (written == 0) {
+        return 1;
+    }
+
+    printf("%s: %dx%d, %u bytes (%u%% of raw) in %u ms\n", path, width, height, written,
+           written * 100U / (width * height * 3U), (uint32_t)((esp_timer_get_time() - start_us) / 1000));
+    if (screenshot_args.print->count) {
+        screenshot_print(path);
+    }
+    return 0;
+}
+
+static void register_screenshot()
+{
+    screenshot_args.path = arg_str0(NULL, NULL, "<path>", "File to write, " SCREENSHOT_PATH " when omitted");
+    screenshot_args.lcd = arg_int0("l", "lcd", "<n>", "LCD instance, the default display when omitted");
+    screenshot_args.print = arg_lit0("p", "print", "Also print the file as hex, for xxd -r -p");
+    screenshot_args.end = arg_end(3);
+
+    const esp_console_cmd_t cmd = {
+        .command = "screenshot",
+        .help = "Save what the display shows as a TGA file on the littlefs partition",
+        .hint = NULL,
+        .func = &screenshot,
+        .argtable = &screenshot_args
+    };
+    ESP_ERROR_CHECK( esp_console_cmd_register(&cmd) );
+}
+
+/* 'spi_stats' command: share of the HSPI bus each device used since the last call */
+static int spi_stats(int argc, char **argv)
+{
+    static SPI_BUS_Stats_t last[SPI_BUS_DEVICES_MAX];
+    static int64_t last_us;
+    int64_t now_us = esp_timer_get_time();
+    uint32_t elapsed_us = (uint32_t)(now_us - last_us);
+    SPI_BUS_DevConfig_t cfg;
+    SPI_BUS_Stats_t st;
+
+    printf("%-8s %4s %5s %8s %8s %6s %8s %9s %8s\n",
+           "device", "prio", "MHz", "trans", "KiB", "busy%", "waited", "avg wait", "max wait");
+    for (uint32_t i = 0; i < SPI_BUS_GetDevices(); i++) {
+        SPI_BUS_GetConfig(i, &cfg);
+        SPI_BUS_GetStats(i, &st);
+        uint32_t contended = st.Contended - last[i].Contended;
+        /* 80 MHz cycles on the wire against the microseconds elapsed */
+        uint32_t busy = elapsed_us ? (uint32_t)((st.WireCycles - last[i].WireCycles) * 100U / (80ULL * elapsed_us)) : 0;
+        printf("%-8s %4u %5u %8u %8u %6u %8u %7uus %6uus\n",
+               cfg.Name ? cfg.Name : "-", cfg.Priority, 80U / cfg.ClkDiv,
+               st.Transactions - last[i].Transactions, (uint32_t)((st.Bytes - last[i].Bytes) / 1024U), busy,
+               contended, contended ? (uint32_t)((st.WaitUs - last[i].WaitUs) / contended) : 0, st.MaxWaitUs);
+        last[i] = st;
+    }
+    printf("over %u ms\n", elapsed_us / 1000U);
+    last_us = now_us;
+    return 0;
+}
+
+static void register_spi_stats()
+{
+    const esp_console_cmd_t cmd = {
+        .command = "spi_stats",
+        .help = "Print the HSPI bus use of every device since the last call",
+        .hint = NULL,
+        .func = &spi_stats,
+    };
+    ESP_ERROR_CHECK( esp_console_cmd_register(&cmd) );
+}
+
+void register_lcd()
+{
+    register_lcd_bench();
+    register_lcd_stats();
+    register_lcd_font();
+    register_lcd_depth();
+    register_lcd_idle();
+    register_lcd_fps();
+    register_lcd_sleep();
+    register_screenshot();
+    register_spi_stats();
+}
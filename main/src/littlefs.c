@@ -143,7 +143,6 @@ void littlefs_init(void)
         }
         ESP_LOGI(TAG, "Read from file: '%s'", line);
 
-        // All done, unmount partition and disable LittleFS
-        esp_vfs_littlefs_unregister(conf.partition_label);
-        ESP_LOGI(TAG, "LittleFS unmounted");
+        // All done, keep the partition mounted: the LCD font is read from it
+        ESP_LOGI(TAG, "LittleFS mounted at %s", conf.base_path);
 }
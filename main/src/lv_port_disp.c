@@ -11,25 +11,194 @@
  *********************/
 #include "lv_port_disp.h"
 #include "lvgl.h"
+#include "lcd.h"
+#include "esp_attr.h"
 
 /*********************
  *      DEFINES
  *********************/
+#define MY_DISP_HOR_RES LCD_PANEL_WIDTH  /*From the panel profile, see st7735_panel.h*/
+#define MY_DISP_VER_RES LCD_PANEL_HEIGHT
+
+/*Transactions per window when CASET/RASET parameters went out one byte at a time*/
+#define DISP_WINDOW_TRANSACTIONS_UNPACKED 11U
+/*Fixed cost of one flush in pixel times: address window, flush_cb and the transfer
+ *completion interrupt, about 40 us against 0.4 us per pixel at 40 MHz*/
+#define DISP_FLUSH_COST_PX 96U
+
+/*Skip tiles whose pixels hash the same as what was last sent, costs 4 bytes per tile*/
+#ifndef DISP_TILE_DIFF
+#define DISP_TILE_DIFF (LV_COLOR_DEPTH == 16)
+#endif
+#define DISP_TILE 8
+#define DISP_TILE_COLS ((MY_DISP_HOR_RES + DISP_TILE - 1) / DISP_TILE)
+#define DISP_TILE_ROWS ((MY_DISP_VER_RES + DISP_TILE - 1) / DISP_TILE)
+
+/*Rows per draw buffer. LV_COLOR_DEPTH 8 renders RGB332 (or palette indices), one
+ *byte per pixel expanded through a lookup table while the FIFO is filled: the
+ *same RAM holds twice the rows. Two 128 x 20 RGB332 buffers take 5120 bytes.
+ *Wider panels get fewer rows in the same RAM. With the tile diff the rounder pads
+ *every area to whole tiles, LVGL draws nothing if no strip of whole tiles fits:
+ *the rows are a multiple of DISP_TILE, at least one tile, so two 128 x 8 RGB565
+ *buffers take 4096 bytes and two 240 x 8 ones 7680*/
+#define DISP_BUF_BYTES 2560
+#define DISP_BUF_FIT_ROWS (DISP_BUF_BYTES / (MY_DISP_HOR_RES * (LV_COLOR_DEPTH == 8 ? 1 : 2)))
+#ifndef DISP_BUF_ROWS
+#if DISP_TILE_DIFF
+#define DISP_BUF_ROWS (DISP_BUF_FIT_ROWS < DISP_TILE ? DISP_TILE : DISP_BUF_FIT_ROWS / DISP_TILE * DISP_TILE)
+#else
+#define DISP_BUF_ROWS DISP_BUF_FIT_ROWS
+#endif
+#endif
+
+#if DISP_TILE_DIFF && (DISP_BUF_ROWS < DISP_TILE)
+#error "DISP_TILE_DIFF needs draw buffers of at least DISP_TILE rows"
+#endif
+
+/*Above this share of changed pixels the whole area is streamed in the background*/
+#define DISP_TILE_DIFF_MAX_PERCENT 75U
+/*Tag of the tile band hashes kept in RTC memory across deep sleep*/
+#define DISP_RESUME_MAGIC 0x44535052U
+
+/*Screens that can have their own bus colour depth, see lv_port_disp_set_depth()*/
+#define DISP_DEPTH_SCREENS 4
+
+/*Every panel on the bus is an LVGL display of its own, the LCD instance is kept
+ *in the driver's user_data*/
+#define DISP_INSTANCE(drv) ((uint32_t)(uintptr_t)(drv)->user_data)
+
+/*Panel power governor: after DISP_IDLE_MS without an invalidated area the panel
+ *goes to the mode set by lv_port_disp_set_idle()*/
+#ifndef DISP_IDLE_MS
+#define DISP_IDLE_MS 2000
+#endif
+
+/*Frame rate governor: while the display changes LVGL refreshes at the target rate,
+ *see lv_port_disp_set_fps(), and the panel scans at least as fast but never below
+ *DISP_PANEL_MIN_FPS. After DISP_STATIC_MS without an invalidated area the display
+ *is static, whatever the panel mode: it is refreshed at DISP_STATIC_FPS only, an
+ *invalidated area still gets the next timer run, and the panel scans at
+ *DISP_IDLE_FPS*/
+#ifndef DISP_STATIC_MS
+#define DISP_STATIC_MS 1000
+#endif
+#ifndef DISP_IDLE_FPS
+#define DISP_IDLE_FPS 31
+#endif
+#ifndef DISP_PANEL_MIN_FPS
+#define DISP_PANEL_MIN_FPS 60
+#endif
+#ifndef DISP_STATIC_FPS
+#define DISP_STATIC_FPS 5
+#endif
+#define DISP_FPS_MAX 100
 
 /**********************
  *      TYPEDEFS
  **********************/
+typedef struct
+{
+    lv_obj_t *scr; /*NULL: free entry*/
+    uint8_t depth; /*12 or 16 bits per pixel on the bus*/
+    bool dither;
+} disp_depth_t;
+
+/*What a panel showed when it was put to sleep: one hash per band of DISP_TILE
+ *lines, folded from its tile hashes, 0: unknown*/
+typedef struct
+{
+    uint32_t magic;
+    uint32_t band[DISP_TILE_ROWS];
+    uint32_t checksum;
+} disp_resume_t;
+
+/*Screenshot in progress, see lv_port_disp_capture_start(). The rows are handed to
+ *the reader through `rows`: set by disp_flush(), cleared by the reader once done*/
+typedef struct
+{
+    int32_t instance;         /*-1: no capture*/
+    uint16_t *buf;            /*full-width RGB565 rows for the reader*/
+    uint32_t buf_rows;
+    lv_coord_t next;          /*first row not captured yet*/
+    volatile lv_coord_t y;    /*first row in buf*/
+    volatile uint32_t rows;   /*rows in buf, 0: buf is free*/
+} disp_capture_t;
 
 /**********************
  *  STATIC PROTOTYPES
  **********************/
 static void disp_init(void);
+static void disp_register(uint32_t instance);
 
 static void disp_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p);
+static void disp_monitor(lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px);
+static void disp_rounder(lv_disp_drv_t *disp_drv, lv_area_t *area);
+static void disp_refr_timer(lv_timer_t *timer);
+static uint32_t disp_coalesce(lv_disp_t *disp);
+static void disp_apply_depth(lv_disp_t *disp);
+static void disp_govern(lv_disp_t *disp);
+static void disp_wake(uint32_t instance);
+static void disp_set_rate(uint32_t instance, uint32_t fps);
+static void disp_capture_band(lv_disp_t *disp);
+static void disp_capture(uint32_t instance, const lv_area_t *area, const lv_color_t *color_p);
+#if DISP_TILE_DIFF
+static bool disp_flush_diff(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p);
+static void disp_send_run(lv_disp_drv_t *disp_drv, const lv_area_t *part, const lv_area_t *area,
+                          lv_color_t *color_p, bool last);
+static uint32_t disp_band_hash(const uint32_t *tiles);
+static uint32_t disp_resume_sum(const disp_resume_t *resume);
+#endif
 
 /**********************
  *  STATIC VARIABLES
  **********************/
+static lv_disp_t *disps[LCD_INSTANCES_NBR];
+/*Driver whose buffer is on the wire, released from LCD_SignalTransferDone()*/
+static lv_disp_drv_t *flushing_drv[LCD_INSTANCES_NBR];
+/*Per-frame bus statistics of every display, see lv_port_disp_get_stats()*/
+static lv_port_disp_stats_t frame_stats[LCD_INSTANCES_NBR];
+static LCD_Stats_t frame_base[LCD_INSTANCES_NBR];
+static uint32_t frame_flushes[LCD_INSTANCES_NBR];
+static uint32_t frame_areas[LCD_INSTANCES_NBR];
+static uint32_t frame_merged[LCD_INSTANCES_NBR];
+static uint32_t frame_saved_bytes[LCD_INSTANCES_NBR];
+static uint32_t total_saved_bytes[LCD_INSTANCES_NBR];
+/*Bus colour depth of the listed screens and of all the others*/
+static disp_depth_t depth_tab[DISP_DEPTH_SCREENS];
+static disp_depth_t depth_default = {NULL, 16, false};
+static uint8_t bus_depth[LCD_INSTANCES_NBR];
+static bool bus_dither[LCD_INSTANCES_NBR];
+/*Power governor policy, and per panel the time of the last invalidated area.
+ *idle_since 0: the panel is in full mode*/
+static uint32_t idle_ms = DISP_IDLE_MS;
+static uint8_t idle_mode = LCD_POWER_MODE_NORMAL;
+static lv_coord_t idle_y1;
+static lv_coord_t idle_y2;
+static uint32_t active_tick[LCD_INSTANCES_NBR];
+/*Frame rate governor target and the frames each display refreshed*/
+static uint32_t target_fps = 1000 / LV_DISP_DEF_REFR_PERIOD;
+static uint32_t frames_done[LCD_INSTANCES_NBR];
+static uint32_t idle_since[LCD_INSTANCES_NBR];
+/*static_since 0: the display changes, it has the target rates*/
+static uint32_t static_since[LCD_INSTANCES_NBR];
+static uint32_t idle_total_ms[LCD_INSTANCES_NBR];
+static disp_capture_t capture = {.instance = -1};
+#if LV_COLOR_DEPTH == 8
+/*RGB565 of every 8-bit colour, read from the SPI interrupt*/
+static uint16_t disp_lut[256];
+#endif
+#if DISP_TILE_DIFF
+/*Cleared by lv_port_disp_set_diff() to stream every area as it is*/
+static bool diff_enabled = true;
+/*Hash of the pixels last sent for every tile, 0: unknown*/
+static uint32_t tile_hash[LCD_INSTANCES_NBR][DISP_TILE_ROWS * DISP_TILE_COLS];
+/*Tiles of the area being flushed that have to be sent*/
+static uint8_t tile_dirty[DISP_TILE_ROWS * DISP_TILE_COLS];
+/*Band hashes saved by lv_port_disp_sleep(), and the ones of a resumed panel that
+ *were not redrawn yet*/
+static RTC_DATA_ATTR disp_resume_t disp_resume[LCD_INSTANCES_NBR];
+static uint32_t resume_band[LCD_INSTANCES_NBR][DISP_TILE_ROWS];
+#endif
 
 /**********************
  *      MACROS
@@ -41,14 +210,23 @@ static void disp_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_
 
 void lv_port_disp_init(void)
 {
-#define USING_BUFX 1
-#define MY_DISP_HOR_RES 128
-#define MY_DISP_VER_RES 160
+#define USING_BUFX 2
     /*-------------------------
      * Initialize your display
      * -----------------------*/
     disp_init();
 
+    /*One display per panel, each with its own buffers: while one panel's strip is
+     *on the bus the other display can be rendered*/
+    for (uint32_t i = 0; i < LCD_INSTANCES_NBR; i++)
+    {
+        disp_register(i);
+    }
+}
+
+/*Create the LVGL display of an LCD instance*/
+static void disp_register(uint32_t instance)
+{
     /*-----------------------------
      * Create a buffer for drawing
      *----------------------------*/
@@ -75,15 +253,15 @@ void lv_port_disp_init(void)
      */
 #if (USING_BUFX == 1)
     /* Example for 1) */
-    static lv_disp_draw_buf_t draw_buf_dsc_1;
-    static lv_color_t buf_1[MY_DISP_HOR_RES * 10];                             /*A buffer for 10 rows*/
-    lv_disp_draw_buf_init(&draw_buf_dsc_1, buf_1, NULL, MY_DISP_HOR_RES * 10); /*Initialize the display buffer*/
+    static lv_disp_draw_buf_t draw_buf_dsc_1[LCD_INSTANCES_NBR];
+    static lv_color_t buf_1[LCD_INSTANCES_NBR][MY_DISP_HOR_RES * DISP_BUF_ROWS];                                     /*A buffer for DISP_BUF_ROWS rows*/
+    lv_disp_draw_buf_init(&draw_buf_dsc_1[instance], buf_1[instance], NULL, MY_DISP_HOR_RES * DISP_BUF_ROWS); /*Initialize the display buffer*/
 #elif (USING_BUFX == 2)
     /* Example for 2) */
-    static lv_disp_draw_buf_t draw_buf_dsc_2;
-    static lv_color_t buf_2_1[MY_DISP_HOR_RES * 10 * sizeof(lv_color_t)];           /*A buffer for 10 rows*/
-    static lv_color_t buf_2_2[MY_DISP_HOR_RES * 10 * sizeof(lv_color_t)];           /*An other buffer for 10 rows*/
-    lv_disp_draw_buf_init(&draw_buf_dsc_2, buf_2_1, buf_2_2, MY_DISP_HOR_RES * 10); /*Initialize the display buffer*/
+    static lv_disp_draw_buf_t draw_buf_dsc_2[LCD_INSTANCES_NBR];
+    static lv_color_t buf_2_1[LCD_INSTANCES_NBR][MY_DISP_HOR_RES * DISP_BUF_ROWS];                                                /*A buffer for DISP_BUF_ROWS rows*/
+    static lv_color_t buf_2_2[LCD_INSTANCES_NBR][MY_DISP_HOR_RES * DISP_BUF_ROWS];                                                /*An other buffer for DISP_BUF_ROWS rows*/
+    lv_disp_draw_buf_init(&draw_buf_dsc_2[instance], buf_2_1[instance], buf_2_2[instance], MY_DISP_HOR_RES * DISP_BUF_ROWS); /*Initialize the display buffer*/
 #else
     /* Example for 3) also set disp_drv.full_refresh = 1 below*/
     static lv_disp_draw_buf_t draw_buf_dsc_3;
@@ -95,24 +273,30 @@ void lv_port_disp_init(void)
      * Register the display in LVGL
      *----------------------------------*/
 
-    static lv_disp_drv_t disp_drv; /*Descriptor of a display driver*/
-    lv_disp_drv_init(&disp_drv);   /*Basic initialization*/
+    static lv_disp_drv_t disp_drvs[LCD_INSTANCES_NBR];
+    lv_disp_drv_t *disp_drv = &disp_drvs[instance]; /*Descriptor of a display driver*/
+    lv_disp_drv_init(disp_drv);                     /*Basic initialization*/
+    disp_drv->user_data = (void *)(uintptr_t)instance;
 
     /*Set up the functions to access to your display*/
 
     /*Set the resolution of the display*/
-    disp_drv.hor_res = MY_DISP_HOR_RES;
-    disp_drv.ver_res = MY_DISP_VER_RES;
+    disp_drv->hor_res = MY_DISP_HOR_RES;
+    disp_drv->ver_res = MY_DISP_VER_RES;
 
     /*Used to copy the buffer's content to the display*/
-    disp_drv.flush_cb = disp_flush;
+    disp_drv->flush_cb = disp_flush;
+    /*Called after every refreshed frame, collects the bus statistics*/
+    disp_drv->monitor_cb = disp_monitor;
+    /*Align invalidated areas to whole FIFO words*/
+    disp_drv->rounder_cb = disp_rounder;
 #if (USING_BUFX == 1)
     /*Set a display buffer*/
-    disp_drv.draw_buf = &draw_buf_dsc_1;
+    disp_drv->draw_buf = &draw_buf_dsc_1[instance];
 #elif (USING_BUFX == 2)
-    disp_drv.draw_buf = &draw_buf_dsc_2;
+    disp_drv->draw_buf = &draw_buf_dsc_2[instance];
 #else
-    disp_drv.draw_buf = &draw_buf_dsc_3;
+    disp_drv->draw_buf = &draw_buf_dsc_3;
 #endif
 
     /*Required for Example 3)*/
@@ -124,7 +308,224 @@ void lv_port_disp_init(void)
     // disp_drv.gpu_fill_cb = gpu_fill;
 
     /*Finally register the driver*/
-    lv_disp_drv_register(&disp_drv);
+    lv_disp_t *disp = lv_disp_drv_register(disp_drv);
+    disps[instance] = disp;
+
+    /*Merge the invalidated areas with the flush cost model before every refresh*/
+    lv_timer_set_cb(disp->refr_timer, disp_refr_timer);
+    disp_set_rate(instance, target_fps);
+
+#if DISP_TILE_DIFF
+    /*A panel resumed from deep sleep still shows the last frame: the bands that
+     *render the same again are not sent*/
+    if(Lcd_Ctx[instance].Resumed && disp_resume[instance].magic == DISP_RESUME_MAGIC &&
+       disp_resume[instance].checksum == disp_resume_sum(&disp_resume[instance])) {
+        lv_memcpy(resume_band[instance], disp_resume[instance].band, sizeof(resume_band[instance]));
+    }
+    disp_resume[instance].magic = 0;
+#endif
+}
+
+/*LVGL display of an LCD instance, NULL when there is no such panel. The first
+ *one registered is LVGL's default display*/
+lv_disp_t *lv_port_disp_get(uint32_t instance)
+{
+    return instance < LCD_INSTANCES_NBR ? disps[instance] : NULL;
+}
+
+/*Copy the statistics of the last frame a display refreshed*/
+void lv_port_disp_get_stats(uint32_t instance, lv_port_disp_stats_t *stats)
+{
+    if(instance >= LCD_INSTANCES_NBR) {
+        lv_memset_00(stats, sizeof(*stats));
+        return;
+    }
+    *stats = frame_stats[instance];
+}
+
+/*Set the bus colour depth used while `scr` is the active screen, NULL for the
+ *screens without their own. 12 bits cut the bytes sent per pixel by a quarter,
+ *`dither` hides the banding. Depth 0 forgets the screen, do it before deleting it.
+ *Returns false when the depth is not 0, 12 or 16 or no entry is free.*/
+bool lv_port_disp_set_depth(lv_obj_t *scr, uint8_t depth, bool dither)
+{
+    disp_depth_t *free_entry = NULL;
+
+    if(depth != 0 && depth != 12 && depth != 16) return false;
+
+    if(scr == NULL) {
+        if(depth == 0) return false;
+        depth_default.depth = depth;
+        depth_default.dither = dither;
+        return true;
+    }
+
+    for(uint32_t i = 0; i < DISP_DEPTH_SCREENS; i++) {
+        if(depth_tab[i].scr == scr) {
+            free_entry = &depth_tab[i];
+            break;
+        }
+        if(depth_tab[i].scr == NULL && free_entry == NULL) free_entry = &depth_tab[i];
+    }
+    if(free_entry == NULL) return depth == 0;
+
+    free_entry->scr = depth ? scr : NULL;
+    free_entry->depth = depth;
+    free_entry->dither = dither;
+    return true;
+}
+
+#if LV_COLOR_DEPTH == 8
+/*Replace the RGB332 expansion by a 256-colour palette, NULL restores RGB332.
+ *LVGL still blends in RGB332, so a palette suits screens drawn from indexed images*/
+void lv_port_disp_set_palette(const uint16_t *palette)
+{
+    /*Wait for the transfers reading the table, then rewrite it*/
+    for(uint32_t i = 0; i < LCD_INSTANCES_NBR; i++) LCD_SetLut(i, NULL);
+    if(palette) lv_memcpy(disp_lut, palette, sizeof(disp_lut));
+    else LCD_MakeLutRGB332(disp_lut);
+    for(uint32_t i = 0; i < LCD_INSTANCES_NBR; i++) {
+        LCD_SetLut(i, disp_lut);
+        if(disps[i]) lv_obj_invalidate(lv_disp_get_scr_act(disps[i]));
+    }
+}
+#endif
+
+/*Set what the panels do once nothing was invalidated for `ms` (0: never).
+ *LCD_POWER_MODE_NORMAL keeps the panel mode, LCD_POWER_MODE_IDLE drops
+ *to 8 colours, LCD_POWER_MODE_PARTIAL keeps the lines y1..y2 lit (a clock, a status
+ *line) and the others dark. The next invalidated area restores the full mode
+ *before the frame that draws it. Returns false for a mode the panels cannot do*/
+bool lv_port_disp_set_idle(uint32_t ms, uint8_t mode, lv_coord_t y1, lv_coord_t y2)
+{
+    if(mode > LCD_POWER_MODE_PARTIAL) return false;
+    if(mode == LCD_POWER_MODE_PARTIAL && (y1 < 0 || y1 > y2 || y2 >= MY_DISP_VER_RES)) return false;
+
+    for(uint32_t i = 0; i < LCD_INSTANCES_NBR; i++) {
+        disp_wake(i);
+        active_tick[i] = lv_tick_get();
+    }
+    idle_ms = ms;
+    idle_mode = mode;
+    idle_y1 = y1;
+    idle_y2 = y2;
+    return true;
+}
+
+/*Set the refresh rate the display gets while it changes, the panel scan rate
+ *follows. Static displays fall back to DISP_STATIC_FPS whatever the target.
+ *Returns false for 0 or more than DISP_FPS_MAX*/
+bool lv_port_disp_set_fps(uint32_t fps)
+{
+    if(fps == 0 || fps > DISP_FPS_MAX) return false;
+
+    target_fps = fps;
+    for(uint32_t i = 0; i < LCD_INSTANCES_NBR; i++) {
+        if(disps[i] && static_since[i] == 0) disp_set_rate(i, fps);
+    }
+    return true;
+}
+
+/*Current rates of a display: the target, LVGL's refresh period, the panel scan
+ *rate and the frames refreshed since boot*/
+void lv_port_disp_get_rate(uint32_t instance, lv_port_disp_rate_t *rate)
+{
+    lv_memset_00(rate, sizeof(*rate));
+    if(instance >= LCD_INSTANCES_NBR || disps[instance] == NULL) return;
+
+    rate->target_fps = target_fps;
+    rate->period_ms = disps[instance]->refr_timer->period;
+    LCD_GetFrameRate(instance, &rate->panel_fps);
+    rate->frames = frames_done[instance];
+    rate->idle = static_since[instance] != 0;
+}
+
+/*Time a panel spent in the idle mode since boot, in ms*/
+uint32_t lv_port_disp_get_idle_time(uint32_t instance)
+{
+    if(instance >= LCD_INSTANCES_NBR) return 0;
+    return idle_total_ms[instance] + (idle_since[instance] ? lv_tick_elaps(idle_since[instance]) : 0);
+}
+
+/*Forget what the panel holds, call it after drawing on the LCD outside LVGL*/
+void lv_port_disp_reset_shadow(void)
+{
+#if DISP_TILE_DIFF
+    lv_memset_00(tile_hash, sizeof(tile_hash));
+    lv_memset_00(resume_band, sizeof(resume_band));
+#endif
+}
+
+/*Turn the tile diff on or off, to set the hashing cost of a frame against the bytes
+ *it saves. Turning it back on forgets the hashes, the panels changed meanwhile.
+ *Returns false when asked to turn on a diff the port is built without*/
+bool lv_port_disp_set_diff(bool enable)
+{
+#if DISP_TILE_DIFF
+    if(enable && !diff_enabled) lv_port_disp_reset_shadow();
+    diff_enabled = enable;
+    return true;
+#else
+    return !enable;
+#endif
+}
+
+/*Start copying what a display shows into `buf`, `rows` full-width RGB565 rows at a
+ *time. The panel cannot be read back over the SPI bus, so the rows are taken from
+ *LVGL's buffers while they are flushed: every refresh invalidates the next band of
+ *rows and nothing else, so a frame costs at most one more strip. Call it with the
+ *GUI locked. Returns false while another capture runs*/
+bool lv_port_disp_capture_start(uint32_t instance, uint16_t *buf, uint32_t rows)
+{
+    if(capture.instance >= 0 || instance >= LCD_INSTANCES_NBR || disps[instance] == NULL) return false;
+    if(buf == NULL || rows == 0) return false;
+
+    capture.buf = buf;
+    capture.buf_rows = rows;
+    capture.next = 0;
+    capture.rows = 0;
+    capture.instance = (int32_t)instance;
+    return true;
+}
+
+/*Rows waiting in the capture buffer, 0 while the next band is not flushed yet. Needs
+ *no lock: the buffer is not written again before lv_port_disp_capture_release()*/
+uint32_t lv_port_disp_capture_read(lv_coord_t *y)
+{
+    uint32_t rows = capture.rows;
+
+    *y = capture.y;
+    return rows;
+}
+
+/*Hand the capture buffer back for the next band*/
+void lv_port_disp_capture_release(void)
+{
+    capture.rows = 0;
+}
+
+/*End the capture, call it with the GUI locked*/
+void lv_port_disp_capture_stop(void)
+{
+    capture.instance = -1;
+    capture.rows = 0;
+}
+
+/*Put the panels to sleep before esp_deep_sleep(). They keep their picture, and
+ *what is needed to take them over is saved in RTC memory: after waking, LCD_Resume()
+ *replaces LCD_Init() and the first frame only sends the bands that changed*/
+void lv_port_disp_sleep(void)
+{
+    for(uint32_t i = 0; i < LCD_INSTANCES_NBR; i++) {
+#if DISP_TILE_DIFF
+        for(uint32_t band = 0; band < DISP_TILE_ROWS; band++) {
+            disp_resume[i].band[band] = disp_band_hash(&tile_hash[i][band * DISP_TILE_COLS]);
+        }
+        disp_resume[i].checksum = disp_resume_sum(&disp_resume[i]);
+        disp_resume[i].magic = DISP_RESUME_MAGIC;
+#endif
+        LCD_Sleep(i);
+    }
 }
 
 /**********************
@@ -134,7 +535,17 @@ void lv_port_disp_init(void)
 /*Initialize your display and the required peripherals.*/
 static void disp_init(void)
 {
-    /*You code here*/
+#if LV_COLOR_DEPTH == 8
+    /*lv_color_t is RGB332, expanded while the pixels are streamed*/
+    LCD_MakeLutRGB332(disp_lut);
+#endif
+    for (uint32_t i = 0; i < LCD_INSTANCES_NBR; i++)
+    {
+#if LV_COLOR_DEPTH == 8
+        LCD_SetLut(i, disp_lut);
+#endif
+        bus_depth[i] = 16;
+    }
 }
 
 /*Flush the content of the internal buffer the specific area on the display
@@ -169,11 +580,20 @@ static void disp_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_
 #else
     // if (Lcd)
     {
-#include "st7735s.h"
-
         // st7735s_flush(disp_drv, area, color_p);
         uint32_t width = area->x2 - area->x1 + 1U;
         uint32_t height = area->y2 - area->y1 + 1U;
+        uint32_t instance = DISP_INSTANCE(disp_drv);
+        frame_flushes[instance]++;
+        disp_capture(instance, area, color_p);
+
+#if DISP_TILE_DIFF
+        /*Only the changed tiles were sent, the buffer is released by disp_flush_diff()*/
+        if (diff_enabled && disp_flush_diff(disp_drv, area, color_p))
+        {
+            return;
+        }
+#endif
         // extern void ST7735_DrawBitmap(uint32_t Xpos,
         //                               uint32_t Ypos,
         //                               uint32_t width,
@@ -181,9 +601,17 @@ static void disp_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_
         //                               uint8_t * pBmp);
         // ST7735_DrawBitmap(area->x1, area->y1, width, height, (uint8_t *)color_p);
 
-        extern int32_t LCD_DrawBitmap(uint32_t Instance, uint32_t Xpos, uint32_t Ypos,
-                                      uint32_t width, uint32_t height, uint8_t * pBmp);
-        LCD_DrawBitmap(0, area->x1, area->y1, width, height, (uint8_t *)color_p);
+#if (USING_BUFX == 2)
+        /*Render into the other buffer while this one is streamed from the SPI interrupt,
+         *'lv_disp_flush_ready()' is then called by LCD_SignalTransferDone(). A transfer
+         *of the other panel still on the bus is waited for by the LCD driver*/
+        flushing_drv[instance] = disp_drv;
+        if (LCD_DrawBitmapAsync(instance, area->x1, area->y1, width, height, (uint8_t *)color_p) == BSP_ERROR_NONE)
+        {
+            return;
+        }
+#endif
+        LCD_DrawBitmap(instance, area->x1, area->y1, width, height, (uint8_t *)color_p);
 
         // Lcd->Region.X.start = area->x1, Lcd->Region.X.end = area->x2;
         // Lcd->Region.X.len = Lcd->Region.X.end - Lcd->Region.X.start + 1U;
@@ -207,6 +635,426 @@ static void disp_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_
     lv_disp_flush_ready(disp_drv);
 }
 
+/*Even x1 and odd x2: every row is a whole number of 32-bit FIFO words (2 pixels each).
+ *With the tile diff, areas and therefore LVGL's strips cover whole tiles*/
+static void disp_rounder(lv_disp_drv_t *disp_drv, lv_area_t *area)
+{
+#if DISP_TILE_DIFF
+    area->x1 &= ~(DISP_TILE - 1);
+    area->x2 |= DISP_TILE - 1;
+    area->y1 &= ~(DISP_TILE - 1);
+    area->y2 |= DISP_TILE - 1;
+    if (area->y2 >= disp_drv->ver_res)
+    {
+        area->y2 = disp_drv->ver_res - 1;
+    }
+#else
+    area->x1 &= ~1;
+    area->x2 |= 1;
+#endif
+    if (area->x2 >= disp_drv->hor_res)
+    {
+        area->x2 = disp_drv->hor_res - 1;
+    }
+
+    /*Called for every invalidated area: a static display is refreshed at a low
+     *rate, have the change drawn at the next timer run instead of a period later*/
+    uint32_t instance = DISP_INSTANCE(disp_drv);
+    if(static_since[instance] && disps[instance]) lv_timer_ready(disps[instance]->refr_timer);
+}
+
+/*Cost of refreshing an area: LVGL renders and flushes it in strips of as many rows
+ *as fit in the draw buffer, each strip pays DISP_FLUSH_COST_PX*/
+static uint32_t disp_area_cost(const lv_disp_t *disp, const lv_area_t *area)
+{
+    uint32_t width = lv_area_get_width(area);
+    uint32_t height = lv_area_get_height(area);
+    uint32_t rows = disp->driver->draw_buf->size / width;
+
+    if (rows == 0)
+    {
+        rows = 1;
+    }
+    return ((height + rows - 1U) / rows) * DISP_FLUSH_COST_PX + width * height;
+}
+
+/*Join invalidated areas while the bounding box costs no more than the two areas,
+ *returns the number of areas left*/
+static uint32_t disp_coalesce(lv_disp_t *disp)
+{
+    lv_area_t joined;
+    uint32_t i, j, left = 0;
+    bool merged = true;
+
+    while (merged)
+    {
+        merged = false;
+        for (i = 0; i < disp->inv_p; i++)
+        {
+            if (disp->inv_area_joined[i])
+            {
+                continue;
+            }
+            for (j = i + 1U; j < disp->inv_p; j++)
+            {
+                if (disp->inv_area_joined[j])
+                {
+                    continue;
+                }
+                _lv_area_join(&joined, &disp->inv_areas[i], &disp->inv_areas[j]);
+                if (disp_area_cost(disp, &joined) <=
+                    disp_area_cost(disp, &disp->inv_areas[i]) + disp_area_cost(disp, &disp->inv_areas[j]))
+                {
+                    disp->inv_areas[i] = joined;
+                    disp->inv_area_joined[j] = 1;
+                    merged = true;
+                }
+            }
+        }
+    }
+
+    for (i = 0; i < disp->inv_p; i++)
+    {
+        left += disp->inv_area_joined[i] ? 0U : 1U;
+    }
+    return left;
+}
+
+#if DISP_TILE_DIFF
+/*FNV-1a over the pixels of a tile clipped to the area, never 0*/
+static uint32_t disp_tile_hash(const lv_color_t *color_p, uint32_t stride, uint32_t w, uint32_t h)
+{
+    uint32_t hash = 2166136261U;
+    uint32_t x, y;
+
+    for (y = 0; y < h; y++)
+    {
+        for (x = 0; x < w; x++)
+        {
+            hash = (hash ^ color_p[x].full) * 16777619U;
+        }
+        color_p += stride;
+    }
+    return hash ? hash : 1U;
+}
+
+/*Hash the tiles of the area and send only the runs of changed tiles of every tile row,
+ *each row of a run straight from the draw buffer. Every run but the last is sent
+ *before the next one is looked for, the last one streams in the background and
+ *releases the buffer. Returns false when so much changed that the caller should
+ *stream the whole area*/
+static bool disp_flush_diff(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p)
+{
+    uint32_t instance = DISP_INSTANCE(disp_drv);
+    uint32_t *hashes = tile_hash[instance];
+    uint32_t width = lv_area_get_width(area);
+    uint32_t pixels = width * lv_area_get_height(area);
+    uint32_t changed = 0, sent = 0, band_changed;
+    int32_t tx1 = area->x1 / DISP_TILE, tx2 = area->x2 / DISP_TILE;
+    int32_t ty1 = area->y1 / DISP_TILE, ty2 = area->y2 / DISP_TILE;
+    int32_t tx, ty, run;
+    lv_area_t part, pending;
+    bool have_pending = false;
+    uint32_t hash, idx;
+
+    for (ty = ty1; ty <= ty2; ty++)
+    {
+        band_changed = 0;
+        for (tx = tx1; tx <= tx2; tx++)
+        {
+            part.x1 = LV_MAX(area->x1, tx * DISP_TILE);
+            part.x2 = LV_MIN(area->x2, tx * DISP_TILE + DISP_TILE - 1);
+            part.y1 = LV_MAX(area->y1, ty * DISP_TILE);
+            part.y2 = LV_MIN(area->y2, ty * DISP_TILE + DISP_TILE - 1);
+            idx = ty * DISP_TILE_COLS + tx;
+            hash = disp_tile_hash(color_p + (part.y1 - area->y1) * width + (part.x1 - area->x1), width,
+                                  lv_area_get_width(&part), lv_area_get_height(&part));
+            if ((part.x2 - part.x1 + 1 < DISP_TILE) || (part.y2 - part.y1 + 1 < DISP_TILE))
+            {
+                /*Partly covered: the hash does not describe the tile*/
+                hash = 0;
+                tile_dirty[idx] = 1;
+            }
+            else
+            {
+                tile_dirty[idx] = (hash != hashes[idx]);
+            }
+            hashes[idx] = hash;
+            band_changed += tile_dirty[idx] ? lv_area_get_size(&part) : 0U;
+        }
+
+        /*First redraw of a band after resuming: unchanged, it is on the panel already*/
+        if (resume_band[instance][ty])
+        {
+            if ((tx1 == 0) && (tx2 == DISP_TILE_COLS - 1) &&
+                (disp_band_hash(&hashes[ty * DISP_TILE_COLS]) == resume_band[instance][ty]))
+            {
+                lv_memset_00(&tile_dirty[ty * DISP_TILE_COLS], DISP_TILE_COLS);
+                band_changed = 0;
+            }
+            resume_band[instance][ty] = 0;
+        }
+        changed += band_changed;
+    }
+
+    if (changed * 100U > pixels * DISP_TILE_DIFF_MAX_PERCENT)
+    {
+        return false;
+    }
+
+    for (ty = ty1; ty <= ty2; ty++)
+    {
+        for (tx = tx1; tx <= tx2; tx = run)
+        {
+            if (!tile_dirty[ty * DISP_TILE_COLS + tx])
+            {
+                run = tx + 1;
+                continue;
+            }
+            for (run = tx + 1; run <= tx2 && tile_dirty[ty * DISP_TILE_COLS + run]; run++)
+            {
+            }
+            part.x1 = LV_MAX(area->x1, tx * DISP_TILE);
+            part.x2 = LV_MIN(area->x2, run * DISP_TILE - 1);
+            part.y1 = LV_MAX(area->y1, ty * DISP_TILE);
+            part.y2 = LV_MIN(area->y2, ty * DISP_TILE + DISP_TILE - 1);
+            if(have_pending) disp_send_run(disp_drv, &pending, area, color_p, false);
+            pending = part;
+            have_pending = true;
+            sent += lv_area_get_size(&part);
+        }
+    }
+
+    frame_saved_bytes[instance] += (pixels - sent) * sizeof(lv_color_t);
+    total_saved_bytes[instance] += (pixels - sent) * sizeof(lv_color_t);
+    if(have_pending) disp_send_run(disp_drv, &pending, area, color_p, true);
+    else lv_disp_flush_ready(disp_drv);
+    return true;
+}
+
+/*Send a run of changed tiles of the area rendered at color_p. The last run of a
+ *flush streams from the SPI interrupt and LCD_SignalTransferDone() releases the
+ *buffer, or is sent before releasing it when the driver cannot*/
+static void disp_send_run(lv_disp_drv_t *disp_drv, const lv_area_t *part, const lv_area_t *area,
+                          lv_color_t *color_p, bool last)
+{
+    uint32_t instance = DISP_INSTANCE(disp_drv);
+    uint32_t width = lv_area_get_width(area);
+    uint8_t *p = (uint8_t *)(color_p + (part->y1 - area->y1) * width + (part->x1 - area->x1));
+
+#if (USING_BUFX == 2)
+    if(last) {
+        flushing_drv[instance] = disp_drv;
+        if(LCD_FillRGBRectStrideAsync(instance, part->x1, part->y1, p, lv_area_get_width(part),
+                                      lv_area_get_height(part), width) == BSP_ERROR_NONE) {
+            return;
+        }
+    }
+#endif
+    LCD_FillRGBRectStride(instance, part->x1, part->y1, p, lv_area_get_width(part), lv_area_get_height(part), width);
+    if(last) lv_disp_flush_ready(disp_drv);
+}
+
+/*Fold the tile hashes of a band, 0 when one of them is unknown*/
+static uint32_t disp_band_hash(const uint32_t *tiles)
+{
+    uint32_t hash = 0;
+
+    for(uint32_t i = 0; i < DISP_TILE_COLS; i++) {
+        if(tiles[i] == 0) return 0;
+        hash = ((hash << 5) | (hash >> 27)) ^ tiles[i];
+    }
+    return hash ? hash : 1;
+}
+
+/*RTC memory holds garbage after power-up*/
+static uint32_t disp_resume_sum(const disp_resume_t *resume)
+{
+    uint32_t sum = 0xA5A5A5A5;
+
+    for(uint32_t i = 0; i < DISP_TILE_ROWS; i++) sum = ((sum << 5) | (sum >> 27)) ^ resume->band[i];
+    return sum;
+}
+#endif
+
+/*Display refresh timer: coalesce, then let LVGL refresh what is left*/
+static void disp_refr_timer(lv_timer_t *timer)
+{
+    lv_disp_t *disp = timer->user_data;
+
+    disp_govern(disp);
+    disp_capture_band(disp);
+    if (disp->inv_p != 0)
+    {
+        frame_areas[DISP_INSTANCE(disp->driver)] = disp->inv_p;
+        frame_merged[DISP_INSTANCE(disp->driver)] = disp_coalesce(disp);
+        disp_apply_depth(disp);
+    }
+    _lv_disp_refr_timer(timer);
+}
+
+/*Lower the rates of a static display, and put its panel into the idle mode once
+ *lv_port_disp_set_idle() asks for it. Both are undone as soon as something is
+ *invalidated: the frame drawing the change goes out at the target rates in full
+ *mode. The frame memory is kept in every mode, so nothing has to be redrawn*/
+static void disp_govern(lv_disp_t *disp)
+{
+    uint32_t instance = DISP_INSTANCE(disp->driver);
+    uint32_t quiet;
+
+    if(disp->inv_p != 0) {
+        disp_wake(instance);
+        active_tick[instance] = lv_tick_get();
+        return;
+    }
+    quiet = lv_tick_elaps(active_tick[instance]);
+
+    if(static_since[instance] == 0 && quiet >= DISP_STATIC_MS) {
+        LCD_SetFrameRate(instance, DISP_IDLE_FPS);
+        lv_timer_set_period(disp->refr_timer, 1000 / DISP_STATIC_FPS);
+        static_since[instance] = lv_tick_get();
+        if(static_since[instance] == 0) static_since[instance] = 1;
+    }
+
+    if(idle_since[instance] || idle_ms == 0 || quiet < idle_ms) return;
+
+    if(idle_mode != LCD_POWER_MODE_NORMAL &&
+       LCD_SetPowerMode(instance, idle_mode, (uint32_t)idle_y1, (uint32_t)idle_y2) != BSP_ERROR_NONE) return;
+    idle_since[instance] = lv_tick_get();
+    if(idle_since[instance] == 0) idle_since[instance] = 1;
+}
+
+/*Back to full mode and the target frame rate*/
+static void disp_wake(uint32_t instance)
+{
+    if(idle_since[instance]) {
+        LCD_SetPowerMode(instance, LCD_POWER_MODE_NORMAL, 0, 0);
+        idle_total_ms[instance] += lv_tick_elaps(idle_since[instance]);
+        idle_since[instance] = 0;
+    }
+    if(static_since[instance]) {
+        disp_set_rate(instance, target_fps);
+        static_since[instance] = 0;
+    }
+}
+
+/*Refresh a display at `fps`, the panel scanning at least as fast*/
+static void disp_set_rate(uint32_t instance, uint32_t fps)
+{
+    lv_timer_set_period(disps[instance]->refr_timer, 1000 / fps);
+    LCD_SetFrameRate(instance, LV_MAX(fps, DISP_PANEL_MIN_FPS));
+}
+
+/*Have the next band of a capture redrawn, once the reader took the previous one.
+ *Done after disp_govern(): a static display keeps its power mode*/
+static void disp_capture_band(lv_disp_t *disp)
+{
+    lv_area_t band;
+
+    if(capture.instance != (int32_t)DISP_INSTANCE(disp->driver) || capture.rows != 0) return;
+    if(capture.next >= disp->driver->ver_res) return;
+
+    band.x1 = 0;
+    band.x2 = disp->driver->hor_res - 1;
+    band.y1 = capture.next;
+    band.y2 = LV_MIN(capture.next + (lv_coord_t)capture.buf_rows, disp->driver->ver_res) - 1;
+    _lv_inv_area(disp, &band);
+}
+
+/*Copy the next rows of a capture out of a full-width strip that covers them*/
+static void disp_capture(uint32_t instance, const lv_area_t *area, const lv_color_t *color_p)
+{
+    uint32_t i, n;
+    uint16_t *dst;
+
+    if(capture.instance != (int32_t)instance || capture.rows != 0) return;
+    if(area->x1 != 0 || area->x2 != MY_DISP_HOR_RES - 1) return;
+    if(capture.next < area->y1 || capture.next > area->y2) return;
+
+    n = LV_MIN((uint32_t)(area->y2 - capture.next + 1), capture.buf_rows) * MY_DISP_HOR_RES;
+    color_p += (capture.next - area->y1) * MY_DISP_HOR_RES;
+    dst = capture.buf;
+    for(i = 0; i < n; i++) {
+#if LV_COLOR_DEPTH == 8
+        dst[i] = disp_lut[color_p[i].full];
+#elif LV_COLOR_16_SWAP
+        dst[i] = (uint16_t)((color_p[i].full << 8) | (color_p[i].full >> 8));
+#else
+        dst[i] = lv_color_to16(color_p[i]);
+#endif
+    }
+
+    capture.y = capture.next;
+    capture.next += n / MY_DISP_HOR_RES;
+    capture.rows = n / MY_DISP_HOR_RES; /*Last: hands the rows over*/
+}
+
+/*Switch the bus to the colour depth of the active screen before it is drawn.
+ *The panel keeps its frame memory, so nothing has to be redrawn for it*/
+static void disp_apply_depth(lv_disp_t *disp)
+{
+    lv_obj_t *scr = lv_disp_get_scr_act(disp);
+    const disp_depth_t *d = &depth_default;
+    uint32_t instance = DISP_INSTANCE(disp->driver);
+
+    for(uint32_t i = 0; i < DISP_DEPTH_SCREENS; i++) {
+        if(depth_tab[i].scr == scr) {
+            d = &depth_tab[i];
+            break;
+        }
+    }
+
+    if(d->depth != bus_depth[instance] &&
+       LCD_SetPixelFormat(instance, d->depth == 12 ? LCD_PIXEL_FORMAT_RGB444 : LCD_PIXEL_FORMAT_RGB565) == BSP_ERROR_NONE) {
+        bus_depth[instance] = d->depth;
+    }
+    if(d->dither != bus_dither[instance] && LCD_SetDither(instance, d->dither) == BSP_ERROR_NONE) {
+        bus_dither[instance] = d->dither;
+    }
+}
+
+/*Bus cost of the frame LVGL just refreshed*/
+static void disp_monitor(lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px)
+{
+    uint32_t instance = DISP_INSTANCE(disp_drv);
+    lv_port_disp_stats_t *stats = &frame_stats[instance];
+    LCD_Stats_t *base = &frame_base[instance];
+    LCD_Stats_t now;
+
+    (void)time;
+    (void)px;
+
+    frames_done[instance]++;
+
+    if (LCD_GetStats(instance, &now) != BSP_ERROR_NONE)
+    {
+        return;
+    }
+
+    stats->frames++;
+    stats->flushes = frame_flushes[instance];
+    stats->areas = frame_areas[instance];
+    stats->merged = frame_merged[instance];
+    stats->saved_bytes = frame_saved_bytes[instance];
+    stats->total_saved_bytes = total_saved_bytes[instance];
+    frame_saved_bytes[instance] = 0;
+    stats->windows = now.Windows - base->Windows;
+    stats->transactions = now.Transactions - base->Transactions;
+    stats->saved = stats->windows * DISP_WINDOW_TRANSACTIONS_UNPACKED -
+                   (now.WindowTransactions - base->WindowTransactions);
+    *base = now;
+    frame_flushes[instance] = 0;
+}
+
+/*Called from the SPI interrupt once the flushed buffer is no longer needed*/
+void IRAM_ATTR LCD_SignalTransferDone(uint32_t Instance)
+{
+    if ((Instance < LCD_INSTANCES_NBR) && (flushing_drv[Instance] != NULL))
+    {
+        lv_disp_flush_ready(flushing_drv[Instance]);
+    }
+}
+
 /*OPTIONAL: GPU INTERFACE*/
 
 /*If your MCU has hardware accelerator (GPU) then you can use it to fill a memory with a color*/
@@ -26,6 +26,8 @@
 #include "lv_port_disp.h"
 #include "image.h"
 #include "lcd.h"
+#include "lcd_font.h"
+#include "spi_bus.h"
 // #include "st7735s.h"
 
 static const char* TAG = "main";
@@ -84,6 +86,18 @@ void espx_gpio_init(void)
         __ESPX_GPIOX_INIT(LCD_BLK_PIN, GPIO_MODE_OUTPUT, GPIO_INTR_DISABLE,
                           GPIO_PULLUP_DISABLE, GPIO_PULLDOWN_DISABLE,
                           GPIO_OUTPUT_PIN_SEL(LCD_BLK_PIN)),
+#if SPI_BUS_SOFT_CS
+        /* Software chip selects driven by the bus arbiter, the HSPI one would also
+           select the panel for the other devices' transfers */
+        __ESPX_GPIOX_INIT(LCD_CS_PIN, GPIO_MODE_OUTPUT, GPIO_INTR_DISABLE,
+                          GPIO_PULLUP_DISABLE, GPIO_PULLDOWN_DISABLE,
+                          GPIO_OUTPUT_PIN_SEL(LCD_CS_PIN)),
+#if LCD_INSTANCES_NBR > 1
+        __ESPX_GPIOX_INIT(LCD1_CS_PIN, GPIO_MODE_OUTPUT, GPIO_INTR_DISABLE,
+                          GPIO_PULLUP_DISABLE, GPIO_PULLDOWN_DISABLE,
+                          GPIO_OUTPUT_PIN_SEL(LCD1_CS_PIN) | GPIO_OUTPUT_PIN_SEL(LCD1_DC_PIN)),
+#endif
+#endif
     };
 
     for (esp_gpio_t p = gpio_table; p &&
@@ -124,11 +138,15 @@ void espx_spi_init(void)
         .intr_enable.val = SPI_MASTER_DEFAULT_INTR_ENABLE,
         // Set the SPI clock frequency division factor
         .clk_div = SPI_40MHz_DIV,
-        // Register SPI event callback function
-        .event_cb = NULL,
+        // Register SPI event callback function: refills the FIFO for asynchronous LCD flushes
+        .event_cb = LCD_IO_SpiEventCallback,
     };
     // spi_config.interface.bit_tx_order = 1;
     // spi_config.interface.byte_tx_order = 1;
+#if SPI_BUS_SOFT_CS
+    // The devices' CS lines are driven by spi_bus.c, GPIO15 stays a plain output
+    spi_config.interface.cs_en = 0;
+#endif
     spi_init(HSPI_HOST, &spi_config);
 }
 
@@ -152,9 +170,25 @@ static void gui_task(void *arg)
     (void)arg;
     xGuiSemaphore = xSemaphoreCreateMutex();
 
-    LCD_Init(LCD_NUMBER, LCD_ORIENTATION_PORTRAIT);
+    /* Panels put to sleep by lv_port_disp_sleep() before a deep sleep keep their
+       picture: no reset, no init sequence and no clear for them */
+    int64_t wake_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < LCD_INSTANCES_NBR; i++)
+    {
+        if (LCD_Resume(i) != BSP_ERROR_NONE)
+        {
+            LCD_Init(i, LCD_ORIENTATION_PORTRAIT);
+        }
+    }
+    ESP_LOGI(TAG, "lcd %s in %u us", Lcd_Ctx[0].Resumed ? "resumed" : "initialized",
+             (uint32_t)(esp_timer_get_time() - wake_us));
     // LCD_DisplayOn(0);
     SPI_LCD_BL(GPIO_PIN_SET);
+    /* CJK glyphs are streamed from littlefs, mounted by littlefs_init() */
+    if (LCD_FontOpen(LCD_FONT_PATH) != BSP_ERROR_NONE)
+    {
+        ESP_LOGW(TAG, "no font at %s, CJK text is skipped", LCD_FONT_PATH);
+    }
 
     // vTaskDelay(1000 / portTICK_RATE_MS);
     // LCD_DrawBitmap(LCD_NUMBER, 0, 0, 40, 40, (uint8_t *)gImage_qq);
@@ -159,6 +159,7 @@ void console_init()
     /* Register commands */
     esp_console_register_help_command();
     register_system();
+    register_lcd();
     // register_wifi();
 
     xTaskCreate(console_task, "console", 2048, NULL, 1, NULL);
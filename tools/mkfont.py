@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+"""Build the GBK font file read by components/st7735/src/lcd_font.c.
+
+The source is an HZK-style GB2312 bitmap font (e.g. HZK16): one glyph per
+code point in row order (lead byte 0xA1.., trail byte 0xA1..0xFE), each
+glyph ceil(width / 8) * height bytes, row-major, MSB on the left.
+
+    mkfont.py HZK16 gbk16.fnt                  # whole GB2312 set
+    mkfont.py HZK16 gbk16.fnt --chars ui.txt   # only the characters in ui.txt
+
+Copy the result to /littlefs/gbk16.fnt (LCD_FONT_PATH).
+"""
+import argparse
+import struct
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("hzk", help="HZK-style GB2312 bitmap font")
+    ap.add_argument("out", help="font file to write")
+    ap.add_argument("--size", type=int, default=16, help="glyph width and height (default 16)")
+    ap.add_argument("--chars", help="UTF-8 text file, keep only the characters it uses")
+    args = ap.parse_args()
+
+    glyph_bytes = (args.size + 7) // 8 * args.size
+    data = open(args.hzk, "rb").read()
+
+    wanted = None
+    if args.chars:
+        wanted = set()
+        for ch in open(args.chars, encoding="utf-8").read():
+            code = ch.encode("gbk", errors="ignore")
+            if len(code) == 2:
+                wanted.add(code[0] << 8 | code[1])
+
+    glyphs = {}
+    for n in range(len(data) // glyph_bytes):
+        code = (0xA1 + n // 94) << 8 | (0xA1 + n % 94)
+        bits = data[n * glyph_bytes:(n + 1) * glyph_bytes]
+        if (wanted is None or code in wanted) and any(bits):
+            glyphs[code] = bits
+
+    # Runs of consecutive codes form the index
+    runs = []
+    codes = sorted(glyphs)
+    for i, code in enumerate(codes):
+        if runs and runs[-1][0] + runs[-1][1] == code:
+            runs[-1][1] += 1
+        else:
+            runs.append([code, 1, i])
+
+    with open(args.out, "wb") as f:
+        f.write(b"GFNT" + struct.pack("<BBH", args.size, args.size, len(runs)))
+        for first, count, glyph in runs:
+            f.write(struct.pack("<HHH", first, count, glyph))
+        for code in codes:
+            f.write(glyphs[code])
+    print("%d glyphs in %d runs, %d bytes" % (len(codes), len(runs),
+          8 + 6 * len(runs) + glyph_bytes * len(codes)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,85 @@
+/* Host test of the HSPI FIFO packing in components/st7735/inc/lcd_fifo.h.
+
+   Packs byte streams of 0 .. 130 bytes from every source alignment the way
+   LCD_IO_Transmit() does, one FIFO load per transaction, and checks that the
+   bytes shifted out low byte first (BYTE_TX_ORDER = 0) are the source bytes,
+   the same stream as one transaction per byte, and that the unused bytes of a
+   tail word are 0.
+
+       gcc -Wall -Icomponents/st7735/inc tools/test_lcd_fifo.c -o test_lcd_fifo
+       ./test_lcd_fifo
+*/
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "lcd_fifo.h"
+
+#define MAX_LENGTH 130U
+
+static int check(uint32_t length, uint32_t offset)
+{
+    uint8_t src[MAX_LENGTH + 4U];
+    uint8_t wire[MAX_LENGTH];
+    uint32_t fifo[LCD_FIFO_SIZE / 4U + 1U];
+    uint32_t sent = 0, loads = 0, chunk, i;
+
+    for (i = 0; i < sizeof(src); i++) {
+        src[i] = (uint8_t)(i * 37U + length + 1U);
+    }
+
+    while (sent < length) {
+        memset(fifo, 0xA5, sizeof(fifo));
+        chunk = LCD_FIFO_Pack(fifo, src + offset + sent, length - sent);
+        if (chunk == 0 || chunk > LCD_FIFO_SIZE || (chunk < LCD_FIFO_SIZE && sent + chunk != length)) {
+            printf("length %u offset %u: load of %u bytes after %u\n", length, offset, chunk, sent);
+            return 1;
+        }
+        /* What the SPI shifts out of the loaded words */
+        for (i = 0; i < chunk; i++) {
+            wire[sent + i] = (uint8_t)(fifo[i / 4U] >> (8U * (i % 4U)));
+        }
+        for (i = chunk; i % 4U; i++) {
+            if ((fifo[i / 4U] >> (8U * (i % 4U))) & 0xFFU) {
+                printf("length %u offset %u: tail byte %u not 0\n", length, offset, i);
+                return 1;
+            }
+        }
+        if (fifo[(chunk + 3U) / 4U] != 0xA5A5A5A5U) {
+            printf("length %u offset %u: word %u written past the load\n", length, offset, (chunk + 3U) / 4U);
+            return 1;
+        }
+        sent += chunk;
+        loads++;
+    }
+
+    if (loads != (length + LCD_FIFO_SIZE - 1U) / LCD_FIFO_SIZE) {
+        printf("length %u offset %u: %u FIFO loads\n", length, offset, loads);
+        return 1;
+    }
+    for (i = 0; i < length; i++) {
+        if (wire[i] != src[offset + i]) {
+            printf("length %u offset %u: byte %u is %02x, not %02x\n", length, offset, i, wire[i], src[offset + i]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(void)
+{
+    uint32_t fifo[LCD_FIFO_SIZE / 4U];
+    int failed = 0;
+
+    if (LCD_FIFO_Pack(fifo, (const uint8_t *)"", 0) != 0) {
+        printf("empty stream packed\n");
+        failed++;
+    }
+    for (uint32_t length = 0; length <= MAX_LENGTH; length++) {
+        for (uint32_t offset = 0; offset < 4U; offset++) {
+            failed += check(length, offset);
+        }
+    }
+
+    printf("%s, %u streams\n", failed ? "FAILED" : "passed", (MAX_LENGTH + 1U) * 4U);
+    return failed != 0;
+}